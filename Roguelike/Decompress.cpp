@@ -1,75 +1,84 @@
-#include <algorithm>
-#include <assert.h>
-#include <vector>
 #include <zlib.h>
 #include <stdexcept>
 
-#define CHUNK (1024 * 256)
+#include "Decompress.h"
 
-void write(std::vector<char>& out, const char* buf, size_t bufLen)
-{
-    out.insert(out.end(), buf, buf + bufLen);
-}
+#ifdef ROGUELIKE_USE_LIBDEFLATE
+#include <libdeflate.h>
 
-size_t read(const std::vector<char>& in, char*& inBuf, size_t& inPosition)
-{
-    size_t from = inPosition;
-    inBuf = const_cast<char*>(in.data()) + inPosition;
-    inPosition += std::min<size_t>(CHUNK, in.size() - from);
-    return inPosition - from;
-}
+struct DecompressorDeleter {
+    void operator()(libdeflate_decompressor* decompressor) const {
+        libdeflate_free_decompressor(decompressor);
+    }
+};
 
-std::vector<char> decompressZLIB(const std::vector<char>& in) {
-    int ret;
-    int have;
-    z_stream strm = {};
-    char* inBuf;
-    std::vector<char> outBuffer(CHUNK);
-    char* outBuf = outBuffer.data();
+void decompressZLIB(const char* in, size_t inSize, char* out, size_t outSize) {
+    /* decompressors are reused, one per thread since they are not thread safe */
+    thread_local std::unique_ptr<libdeflate_decompressor, DecompressorDeleter> decompressor;
 
-    std::vector<char> out;
+    if (decompressor == nullptr) {
+        decompressor.reset(libdeflate_alloc_decompressor());
+        if (decompressor == nullptr)
+            throw std::runtime_error("Failed to init libdeflate");
+    }
 
-    size_t inPosition = 0; /* position indicator of "in" */
+    /* without an actual size pointer, libdeflate fails unless the output is filled exactly */
+    switch (libdeflate_zlib_decompress(decompressor.get(), in, inSize, out, outSize, nullptr)) {
+    case LIBDEFLATE_SUCCESS:
+        return;
+    case LIBDEFLATE_SHORT_OUTPUT:
+        throw std::runtime_error("ZLIB output smaller than expected");
+    case LIBDEFLATE_INSUFFICIENT_SPACE:
+        throw std::runtime_error("ZLIB output larger than expected");
+    default:
+        throw std::runtime_error("Failed ZLIB decompress");
+    }
+}
+#endif
 
-    /* allocate inflate state */
-    ret = inflateInit(&strm);
-    if (ret != Z_OK)
-        throw std::runtime_error("Failed to init ZLIB");
+ZLIBInflater::ZLIBInflater(void* out, size_t size) {
+    m_stream = std::make_unique<z_stream>();
+    m_stream->next_out = static_cast<unsigned char*>(out);
+    m_stream->avail_out = static_cast<uInt>(size);
+    m_ended = false;
 
-    /* decompress until deflate stream ends or end of file */
-    do {
-        strm.avail_in = read(in, inBuf, inPosition);
+    if (m_stream->avail_out != size)
+        throw std::runtime_error("ZLIB output too large");
 
-        if (strm.avail_in == 0)
-            break;
-        strm.next_in = (unsigned char*)inBuf;
+    if (inflateInit(m_stream.get()) != Z_OK)
+        throw std::runtime_error("Failed to init ZLIB");
+}
 
-        /* run inflate() on input until output buffer not full */
-        do {
-            strm.avail_out = CHUNK;
-            strm.next_out = (unsigned char*)outBuf;
-            ret = inflate(&strm, Z_NO_FLUSH);
-            assert(ret != Z_STREAM_ERROR); /* state not clobbered */
-            switch (ret) {
-            case Z_NEED_DICT:
-                ret = Z_DATA_ERROR; /* and fall through */
-            case Z_DATA_ERROR:
-            case Z_MEM_ERROR:
-                (void)inflateEnd(&strm);
-                throw std::runtime_error("ZLIB memory error");
-            }
-            have = CHUNK - strm.avail_out;
-            write(out, outBuf, have);
-        } while (strm.avail_out == 0);
+ZLIBInflater::~ZLIBInflater() {
+    (void)inflateEnd(m_stream.get());
+}
 
-        /* done when inflate() says it's done */
-    } while (ret != Z_STREAM_END);
+void ZLIBInflater::write(const void* data, size_t size) {
+    m_stream->next_in = static_cast<unsigned char*>(const_cast<void*>(data));
+    m_stream->avail_in = static_cast<uInt>(size);
 
-    /* clean up and return */
-    (void)inflateEnd(&strm);
-    if (ret != Z_STREAM_END) {
-        throw std::runtime_error("Failed ZLIB decompress");
+    while (m_stream->avail_in > 0 && !m_ended) {
+        int ret = inflate(m_stream.get(), Z_NO_FLUSH);
+
+        switch (ret) {
+        case Z_STREAM_END:
+            m_ended = true;
+            break;
+        case Z_OK:
+            break;
+        case Z_BUF_ERROR:
+            /* input is left over but the output is full */
+            throw std::runtime_error("ZLIB output larger than expected");
+        default:
+            throw std::runtime_error("Failed ZLIB decompress");
+        }
     }
+}
 
-    return out;
-}
\ No newline at end of file
+void ZLIBInflater::finish() {
+    if (!m_ended)
+        throw std::runtime_error("Truncated ZLIB stream");
+
+    if (m_stream->avail_out != 0)
+        throw std::runtime_error("ZLIB output smaller than expected");
+}
@@ -1,4 +1,27 @@
 #pragma once
-#include <vector>
+#include <memory>
 
-std::vector<char> decompressZLIB(const std::vector<char>& in);
\ No newline at end of file
+struct z_stream_s;
+
+#ifdef ROGUELIKE_USE_LIBDEFLATE
+//inflates in one call into a buffer of the expected size, and throws unless the output fills it exactly
+void decompressZLIB(const char* in, size_t inSize, char* out, size_t outSize);
+#endif
+
+//inflates a zlib stream that arrives in pieces straight into a caller owned buffer of known size
+class ZLIBInflater {
+public:
+    ZLIBInflater(void* out, size_t size);
+    ZLIBInflater(const ZLIBInflater& other) = delete;
+    ZLIBInflater& operator = (const ZLIBInflater& other) = delete;
+    ~ZLIBInflater();
+
+    void write(const void* data, size_t size);
+
+    //throws unless the stream has ended and filled the whole output
+    void finish();
+
+private:
+    std::unique_ptr<z_stream_s> m_stream;
+    bool m_ended;
+};
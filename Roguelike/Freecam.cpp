@@ -6,6 +6,7 @@ Freecam::Freecam(SEngine::Window& window, SEngine::Camera& camera) {
     m_camera = &camera;
     m_position = {};
     m_speed = 1;
+    m_moving = false;
 }
 
 void Freecam::update(SEngine::Clock& clock) {
@@ -29,7 +30,9 @@ void Freecam::update(SEngine::Clock& clock) {
     }
 
     glm::vec2 dir = glm::vec2(x, y);
-    if (dir.x != 0 || dir.y != 0) dir = glm::normalize(dir);
+    //while a key is held the engine keeps polling instead of sleeping on input events
+    m_moving = dir.x != 0 || dir.y != 0;
+    if (m_moving) dir = glm::normalize(dir);
     m_position += dir * m_speed * clock.deltaTime();
 
     m_camera->setPosition(m_position);
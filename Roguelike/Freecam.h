@@ -10,6 +10,7 @@ public:
     Freecam& operator = (Freecam&& other) = default;
 
     void update(SEngine::Clock& clock);
+    bool isDirty() const { return m_moving; }
 
     void setSpeed(float speed);
 
@@ -18,4 +19,5 @@ private:
     SEngine::Camera* m_camera;
     glm::vec2 m_position;
     float m_speed;
+    bool m_moving;
 };
\ No newline at end of file
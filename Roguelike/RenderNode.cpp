@@ -1,15 +1,30 @@
 #include "RenderNode.h"
 #include <SimpleEngine/SimpleEngine.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 
-RenderNode::RenderNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, SEngine::AcquireNode& acquireNode, SEngine::TransferNode& transferNode)
+#define CHUNK_SIZE 32
+
+RenderNode::RenderNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, RenderTarget& target, SEngine::TransferNode& transferNode)
     : SEngine::RenderGraph::Node(graph, engine.getGraphics().graphicsQueue()) {
     m_engine = &engine;
     m_graphics = &engine.getGraphics();
-    m_acquireNode = &acquireNode;
+    m_target = &target;
     m_transferNode = &transferNode;
+    m_camera = nullptr;
+    m_map = nullptr;
+    m_renderMode = TileRenderMode::Instances;
+    m_animated = false;
+    m_features = TileFeatureAll;
+    m_drawStride = 0;
 
     m_bufferUsage = std::make_unique<SEngine::RenderGraph::BufferUsage>(*this, vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput);
 
+    //the cull pass reads chunk bounds before any vertex work, so uploads must also be waited on at the compute stage
+    m_computeUsage = std::make_unique<SEngine::RenderGraph::BufferUsage>(*this, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eComputeShader);
+
     m_imageUsage = std::make_unique<SEngine::RenderGraph::ImageUsage>(
         *this, vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits::eColorAttachmentWrite, vk::PipelineStageFlagBits::eColorAttachmentOutput
     );
@@ -18,16 +33,24 @@ RenderNode::RenderNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, SEn
         *this, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader
     );
 
-    createRenderPass();
-    createFramebuffers();
+    m_attachmentFormat = m_target->format();
+
+    if (!m_graphics->dynamicRendering()) {
+        createRenderPass();
+        m_framebuffers.resize(m_target->imageCount());
+    }
     createUniformBuffer();
+    createIndexBuffer();
     createSampler();
     createDescriptorLayout();
     createDescriptorPool();
-    createDescriptor();
-    createPipeline();
+    createDescriptors();
+    createPipelineLayout();
+    createPipelines();
+    createCullDescriptors();
+    createCullPipeline();
 
-    m_swapchainConnection = engine.getGraphics().onSwapchainChanged().connect<&RenderNode::recreateResources>(this);
+    m_targetConnection = target.onChanged().connect<&RenderNode::recreateResources>(this);
     m_uniform = {};
 }
 
@@ -35,125 +58,245 @@ void RenderNode::setCamera(SEngine::Camera& camera) {
     m_camera = &camera;
 }
 
-void RenderNode::loadMap(Tiled::Tileset& tileset, Tiled::Map& map) {
+void RenderNode::setRenderMode(TileRenderMode mode) {
+    m_renderMode = mode;
+}
+
+void RenderNode::loadMap(Tiled::Map& map) {
+    clearMap();
     m_map = &map;
 
-    SEngine::ImageAsset asset = SEngine::readImage("data/" + tileset.image);
-    int32_t extendedImageWidth = tileset.imageWidth - (2 * tileset.margin) + tileset.spacing;
-    int32_t extendedImageHeight = tileset.imageHeight - (2 * tileset.margin) + tileset.spacing;
-    int32_t tileStepX = tileset.tileWidth + tileset.spacing;
-    int32_t tileStepY = tileset.tileHeight + tileset.spacing;
+    createSpritesheet();
+    createAnimationData();
+    m_features = mapFeatures();
 
-    int32_t tileCountX = extendedImageWidth / tileStepX;
-    int32_t tileCountY = extendedImageHeight / tileStepY;
+    if (m_renderMode == TileRenderMode::TileTexture) {
+        createTileImage();
+    } else {
+        createInstanceData();
+        createInstanceBuffer();
+        createChunkBuffers();
+    }
 
-    std::vector<vk::BufferImageCopy> copies;
-    uint32_t tileIndex = 0;
+    invalidateDescriptors();
+}
 
-    vk::Extent3D tileExtent = {
-        static_cast<uint32_t>(tileset.tileWidth),
-        static_cast<uint32_t>(tileset.tileHeight),
-        1
-    };
+void RenderNode::clearMap() {
+    //the builders below fill their ranges in parallel from fresh vectors, so nothing from a previous map may be left in front
+    m_chunks.clear();
+    m_layerChunks.clear();
+    m_chunkBounds.clear();
+    m_dirtyChunks.clear();
+    m_chunkDirty.clear();
+    m_instanceData.clear();
+    m_dirtyLayers.clear();
+    m_tileIDs.clear();
+    m_animationData.clear();
+
+    //connections are released while their buffers are still alive
+    m_instanceRelocatedConnection.release();
+    m_animationRelocatedConnection.release();
+    m_chunkRelocatedConnection.release();
+    m_drawRelocatedConnection.release();
+
+    //buffers and images defer their own destruction, views are retired once the frames using them finish
+    m_instanceBuffer.reset();
+    m_chunkBuffer.reset();
+    m_drawBuffer.reset();
+    m_animationBuffer.reset();
+    m_tileImage.reset();
+    m_spritesheet.reset();
+    graph().queueDestroy(std::move(m_tileImageView));
+    graph().queueDestroy(std::move(m_spritesheetView));
+}
+
+void RenderNode::checkTile(size_t layer, int32_t x, int32_t y, uint32_t gid) const {
+    if (m_map == nullptr) throw std::runtime_error("No map loaded");
+    if (layer >= m_map->layers.size()) throw std::out_of_range("Layer index out of range");
+
+    auto& mapLayer = m_map->layers[layer];
+    if (x < 0 || y < 0 || x >= mapLayer.width || y >= mapLayer.height) throw std::out_of_range("Tile position out of range");
+
+    //GID N is array layer N - 1 of the spritesheet, and 0 is an empty tile
+    if (Tiled::LayerData(gid).id() > m_spritesheet->arrayLayers()) throw std::out_of_range("Tile GID out of range");
+}
+
+void RenderNode::setTile(size_t layer, int32_t x, int32_t y, uint32_t gid) {
+    checkTile(layer, x, y, gid);
+
+    auto& mapLayer = m_map->layers[layer];
+    Tiled::LayerData datum(gid);
+    mapLayer.data[(y * mapLayer.width) + x] = datum;
+
+    if (datum.flipped()) {
+        m_features |= TileFeatureFlip;
+    }
+
+    if (m_tileImage != nullptr) {
+        size_t index = ((size_t)m_tileImageExtent.width * m_tileImageExtent.height * layer) + ((size_t)y * m_tileImageExtent.width) + x;
+        m_tileIDs[index] = gid;
+    }
+
+    markDirty(layer, x, y);
+}
+
+void RenderNode::setTiles(const std::vector<TileChange>& changes) {
+    //every change is checked first, so an invalid one leaves the map untouched
+    for (auto& change : changes) {
+        checkTile(change.layer, change.x, change.y, change.gid);
+    }
 
-    for (int32_t y = 0; y < tileCountY; y++) {
-        for (int32_t x = 0; x < tileCountX; x++) {
-            glm::ivec2 tileOffset = {
-                tileset.margin + x * tileStepX,
-                tileset.margin + y * tileStepY
-            };
-
-            vk::BufferImageCopy copy = {};
-            copy.imageExtent = tileExtent;
-            copy.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-            copy.imageSubresource.baseArrayLayer = tileIndex;
-            copy.imageSubresource.layerCount = 1;
-            copy.imageSubresource.mipLevel = 0;
-            copy.bufferOffset = (((size_t)tileset.imageWidth * tileOffset.y) + (tileOffset.x)) * SEngine::getFormatSize(vk::Format::eR8G8B8A8Srgb);
-
-            copies.push_back(copy);
-            tileIndex++;
+    for (auto& change : changes) {
+        setTile(change.layer, change.x, change.y, change.gid);
+    }
+}
+
+bool RenderNode::isDirty() const {
+    if (m_animated || m_dirtyChunks.size() > 0) return true;
+
+    for (auto& region : m_dirtyLayers) {
+        if (region.dirty) return true;
+    }
+
+    //m_uniform holds the matrices from the last rendered frame
+    if (m_camera != nullptr) {
+        if (m_camera->projectionMatrix() != m_uniform.projectionMatrix) return true;
+        if (m_camera->viewMatrix() != m_uniform.viewMatrix) return true;
+    }
+
+    return false;
+}
+
+void RenderNode::markDirty(size_t layer, int32_t x, int32_t y) {
+    if (m_tileImage != nullptr) {
+        auto& region = m_dirtyLayers[layer];
+
+        if (region.dirty) {
+            region.min = glm::min(region.min, glm::ivec2(x, y));
+            region.max = glm::max(region.max, glm::ivec2(x, y));
+        } else {
+            region.dirty = true;
+            region.min = { x, y };
+            region.max = { x, y };
+        }
+    } else if (m_instanceBuffer != nullptr) {
+        int32_t chunksX = (m_map->layers[layer].width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        uint32_t chunkIndex = m_layerChunks[layer] + ((y / CHUNK_SIZE) * chunksX) + (x / CHUNK_SIZE);
+
+        if (!m_chunkDirty[chunkIndex]) {
+            m_chunkDirty[chunkIndex] = true;
+            m_dirtyChunks.push_back(chunkIndex);
         }
     }
+}
 
-    vk::Format format = vk::Format::eR8G8B8A8Srgb;
+void RenderNode::uploadChanges() {
+    //edits made since the last frame are coalesced into one upload per chunk or per layer
+    for (uint32_t chunkIndex : m_dirtyChunks) {
+        auto& chunk = m_chunks[chunkIndex];
+        uint32_t oldCount = chunk.instanceCount;
 
-    vk::ImageCreateInfo info = {};
-    info.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
-    info.imageType = vk::ImageType::e2D;
-    info.format = format;
-    info.extent = tileExtent;
-    info.arrayLayers = tileIndex;
-    info.mipLevels = 1;
-    info.samples = vk::SampleCountFlagBits::e1;
+        buildChunk(chunk);
+        m_chunkDirty[chunkIndex] = false;
 
-    VmaAllocationCreateInfo allocInfo = {};
-    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        if (chunk.instanceCount != oldCount) {
+            m_chunkBounds[chunkIndex].instanceCount = chunk.instanceCount;
+            m_transferNode->transfer(*m_chunkBuffer, sizeof(ChunkBounds), chunkIndex * sizeof(ChunkBounds), &m_chunkBounds[chunkIndex]);
+        }
 
-    auto& image = m_spritesheets.emplace_back(*m_engine, info, allocInfo);
+        uint32_t count = std::max(oldCount, chunk.instanceCount);
+        if (count == 0) continue;
 
-    vk::Extent3D totalExtent = {
-        static_cast<uint32_t>(tileset.imageWidth),
-        static_cast<uint32_t>(tileset.imageHeight),
-        1
-    };
+        m_transferNode->transfer(*m_instanceBuffer, count * sizeof(TileInstance), chunk.firstInstance * sizeof(TileInstance), &m_instanceData[chunk.firstInstance]);
+    }
 
-    m_transferNode->transfer(image, format, copies, totalExtent, asset.data());
+    m_dirtyChunks.clear();
 
-    vk::ImageViewCreateInfo viewInfo = {};
-    viewInfo.image = image.image();
-    viewInfo.format = format;
-    viewInfo.viewType = vk::ImageViewType::e2DArray;
-    viewInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = tileIndex;
-    viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    for (size_t i = 0; i < m_dirtyLayers.size(); i++) {
+        auto& region = m_dirtyLayers[i];
+        if (!region.dirty) continue;
+
+        uint32_t width = static_cast<uint32_t>(region.max.x - region.min.x + 1);
+        uint32_t height = static_cast<uint32_t>(region.max.y - region.min.y + 1);
+        size_t layerOffset = (size_t)m_tileImageExtent.width * m_tileImageExtent.height * i;
+
+        m_tileScratch.resize((size_t)width * height);
+
+        for (uint32_t y = 0; y < height; y++) {
+            size_t source = layerOffset + ((size_t)(region.min.y + y) * m_tileImageExtent.width) + region.min.x;
+            memcpy(&m_tileScratch[(size_t)y * width], &m_tileIDs[source], width * sizeof(uint32_t));
+        }
+
+        vk::ImageSubresourceLayers subresourceLayers = {};
+        subresourceLayers.aspectMask = vk::ImageAspectFlagBits::eColor;
+        subresourceLayers.baseArrayLayer = static_cast<uint32_t>(i);
+        subresourceLayers.layerCount = 1;
+
+        vk::Offset3D offset = { region.min.x, region.min.y, 0 };
+        vk::Extent3D extent = { width, height, 1 };
 
-    m_spritesheetViews.emplace_back(m_graphics->device(), viewInfo);
+        m_transferNode->transfer(*m_tileImage, offset, extent, subresourceLayers, m_tileScratch.data());
 
-    updateDescriptor();
-    createVertexData();
-    createVertexBuffer();
+        region.dirty = false;
+    }
 }
 
 void RenderNode::preRender(uint32_t currentFrame) {
+    uploadChanges();
+
     if (m_camera != nullptr) {
         m_uniform.projectionMatrix = m_camera->projectionMatrix();
         m_uniform.viewMatrix = m_camera->viewMatrix();
     }
 
+    m_uniform.time = static_cast<uint32_t>(m_engine->renderClock().currentTime() * 1000.0f);
+
+    updateViewBounds();
+
     m_transferNode->transfer(*m_uniformBuffer, sizeof(UniformData), 0, &m_uniform);
 
-    for (auto& spritesheet : m_spritesheets) {
+    if (m_spritesheet != nullptr) {
         vk::ImageSubresourceRange subresource = {};
         subresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-        subresource.layerCount = spritesheet.arrayLayers();
+        subresource.layerCount = m_spritesheet->arrayLayers();
         subresource.levelCount = 1;
 
-        m_textureUsage->sync(spritesheet, subresource);
+        m_textureUsage->sync(*m_spritesheet, subresource);
+    }
+
+    if (m_tileImage != nullptr) {
+        vk::ImageSubresourceRange subresource = {};
+        subresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        subresource.layerCount = m_tileImage->arrayLayers();
+        subresource.levelCount = 1;
+
+        m_textureUsage->sync(*m_tileImage, subresource);
     }
 }
 
 void RenderNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
-    if (m_vertexBuffer == nullptr) return;
-    uint32_t imageIndex = m_acquireNode->swapchainIndex();
-    vk::ClearValue clear = {};
+    //buffers are only relocated before render, and the graph has waited on the last frame that used this frame's sets
+    if (m_descriptorDirty[currentFrame] && m_spritesheetView != nullptr) {
+        updateDescriptor(currentFrame);
+        m_descriptorDirty[currentFrame] = false;
+    }
 
-    vk::RenderPassBeginInfo renderPassInfo = {};
-    renderPassInfo.renderPass = **m_renderPass;
-    renderPassInfo.framebuffer = *m_framebuffers[imageIndex];
-    renderPassInfo.renderArea = vk::Rect2D{ {}, m_graphics->swapchainExtent() };
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clear;
+    if (m_cullDescriptorDirty[currentFrame] && m_chunkBuffer != nullptr) {
+        updateCullDescriptor(currentFrame);
+        m_cullDescriptorDirty[currentFrame] = false;
+    }
 
-    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+    if (m_instanceBuffer == nullptr && m_tileImage == nullptr) return;
+    uint32_t imageIndex = m_target->imageIndex();
+
+    //dispatches are not allowed inside a render pass, so the draw commands are generated first
+    if (m_tileImage == nullptr && m_graphics->drawIndirectFirstInstance()) {
+        cullChunks(currentFrame, commandBuffer);
+    }
 
-    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **m_pipeline);
-    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, **m_pipelineLayout, 0, *m_descriptor, nullptr);
-    commandBuffer.bindVertexBuffers(0, m_vertexBuffer->buffer(), { 0 });
+    beginRendering(commandBuffer, imageIndex);
 
-    vk::Extent2D extent = m_graphics->swapchainExtent();
+    vk::Extent2D extent = m_target->extent();
 
     vk::Viewport viewport = {};
     viewport.minDepth = 0;
@@ -167,30 +310,293 @@ void RenderNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandB
     commandBuffer.setViewport(0, viewport);
     commandBuffer.setScissor(0, scissor);
 
-    commandBuffer.draw(static_cast<uint32_t>(m_vertexData.size()), 1, 0, 0);
+    if (m_tileImage != nullptr) {
+        renderTileImage(currentFrame, commandBuffer);
+    } else {
+        renderInstances(currentFrame, commandBuffer);
+    }
+
+    endRendering(commandBuffer, imageIndex);
+}
+
+void RenderNode::beginRendering(vk::raii::CommandBuffer& commandBuffer, uint32_t imageIndex) {
+    vk::ClearValue clear = {};
+
+#ifdef VK_KHR_dynamic_rendering
+    if (m_graphics->dynamicRendering()) {
+        auto& attachmentInfo = m_imageUsage->attachmentInfo();
+
+        //without a render pass, the layout transition into the attachment layout is recorded by hand
+        vk::ImageMemoryBarrier barrier = {};
+        barrier.image = m_target->image(imageIndex);
+        barrier.oldLayout = attachmentInfo.initialLayout;
+        barrier.newLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        barrier.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.subresourceRange.levelCount = 1;
+
+        if (attachmentInfo.loadOp == vk::AttachmentLoadOp::eLoad) {
+            barrier.dstAccessMask |= vk::AccessFlagBits::eColorAttachmentRead;
+        }
+
+        if (barrier.oldLayout != barrier.newLayout) {
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eColorAttachmentOutput, {},
+                nullptr,
+                nullptr,
+                barrier
+            );
+        }
+
+        vk::RenderingAttachmentInfoKHR colorAttachment = {};
+        colorAttachment.imageView = *m_target->imageView(imageIndex);
+        colorAttachment.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        colorAttachment.loadOp = attachmentInfo.loadOp;
+        colorAttachment.storeOp = attachmentInfo.storeOp;
+        colorAttachment.clearValue = clear;
+
+        vk::RenderingInfoKHR renderingInfo = {};
+        renderingInfo.renderArea = vk::Rect2D{ {}, m_target->extent() };
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachments = &colorAttachment;
+
+        commandBuffer.beginRenderingKHR(renderingInfo);
+        return;
+    }
+#endif
+
+    vk::RenderPassBeginInfo renderPassInfo = {};
+    renderPassInfo.renderPass = **m_renderPass;
+    renderPassInfo.framebuffer = *getFramebuffer(imageIndex);
+    renderPassInfo.renderArea = vk::Rect2D{ {}, m_target->extent() };
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clear;
+
+    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+}
+
+void RenderNode::endRendering(vk::raii::CommandBuffer& commandBuffer, uint32_t imageIndex) {
+#ifdef VK_KHR_dynamic_rendering
+    if (m_graphics->dynamicRendering()) {
+        commandBuffer.endRenderingKHR();
+
+        auto& attachmentInfo = m_imageUsage->attachmentInfo();
+
+        vk::ImageMemoryBarrier barrier = {};
+        barrier.image = m_target->image(imageIndex);
+        barrier.oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        barrier.newLayout = attachmentInfo.finalLayout;
+        barrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.subresourceRange.levelCount = 1;
+
+        if (barrier.oldLayout != barrier.newLayout) {
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eBottomOfPipe, {},
+                nullptr,
+                nullptr,
+                barrier
+            );
+        }
+
+        return;
+    }
+#endif
 
     commandBuffer.endRenderPass();
 }
 
+void RenderNode::cullChunks(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
+    CullPushConstants pushConstants = {};
+    pushConstants.viewMin = m_viewMin;
+    pushConstants.viewMax = m_viewMax;
+    pushConstants.chunkCount = static_cast<uint32_t>(m_chunks.size());
+    pushConstants.compact = m_graphics->drawIndirectCount() ? 1 : 0;
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, **m_cullPipeline);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, **m_cullPipelineLayout, 0, m_cullDescriptors[currentFrame], nullptr);
+    commandBuffer.pushConstants<CullPushConstants>(**m_cullPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, pushConstants);
+    commandBuffer.dispatch(1, 1, 1);
+
+    vk::BufferMemoryBarrier barrier = {};
+    barrier.buffer = m_drawBuffer->buffer();
+    barrier.offset = currentFrame * m_drawStride;
+    barrier.size = m_drawStride;
+    barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, {},
+        nullptr,
+        barrier,
+        nullptr
+    );
+}
+
+void RenderNode::renderInstances(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *getPipeline(*m_pipelines));
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, **m_pipelineLayout, 0, m_descriptors[currentFrame], nullptr);
+    commandBuffer.bindVertexBuffers(0, m_instanceBuffer->buffer(), { 0 });
+    commandBuffer.bindIndexBuffer(m_indexBuffer->buffer(), 0, vk::IndexType::eUint16);
+
+    //every chunk starts at its own firstInstance, which indirect draws can only set with drawIndirectFirstInstance
+    if (!m_graphics->drawIndirectFirstInstance()) {
+        for (auto& chunk : m_chunks) {
+            if (chunk.instanceCount == 0 || !isVisible(chunk)) continue;
+
+            commandBuffer.drawIndexed(6, chunk.instanceCount, 0, 0, chunk.firstInstance);
+        }
+
+        return;
+    }
+
+    //the cull pass wrote this frame's draw count followed by one command per chunk, in draw order
+    vk::Buffer drawBuffer = m_drawBuffer->buffer();
+    vk::DeviceSize countOffset = currentFrame * m_drawStride;
+    vk::DeviceSize commandOffset = countOffset + sizeof(uint32_t);
+    uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+    uint32_t chunkCount = static_cast<uint32_t>(m_chunks.size());
+
+#ifdef VK_KHR_draw_indirect_count
+    if (m_graphics->drawIndirectCount()) {
+        commandBuffer.drawIndexedIndirectCountKHR(drawBuffer, commandOffset, drawBuffer, countOffset, chunkCount, stride);
+        return;
+    }
+#endif
+
+    //without a draw count every chunk gets a command, culled chunks draw zero instances
+    if (m_graphics->multiDrawIndirect()) {
+        commandBuffer.drawIndexedIndirect(drawBuffer, commandOffset, chunkCount, stride);
+        return;
+    }
+
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        commandBuffer.drawIndexedIndirect(drawBuffer, commandOffset + ((vk::DeviceSize)i * stride), 1, stride);
+    }
+}
+
+void RenderNode::renderTileImage(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *getPipeline(*m_tileTexturePipelines));
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, **m_pipelineLayout, 0, m_descriptors[currentFrame], nullptr);
+
+    //one quad per layer, the fragment shader looks up the tile under each pixel
+    for (size_t i = 0; i < m_map->layers.size(); i++) {
+        auto& layer = m_map->layers[i];
+
+        LayerPushConstants pushConstants = {};
+        pushConstants.size = { layer.width, layer.height };
+        pushConstants.layer = static_cast<uint32_t>(i);
+        pushConstants.depth = static_cast<float>(layer.id);
+
+        commandBuffer.pushConstants<LayerPushConstants>(**m_pipelineLayout, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, pushConstants);
+        commandBuffer.draw(6, 1, 0, 0);
+    }
+}
+
+void RenderNode::updateViewBounds() {
+    if (m_camera == nullptr) {
+        m_viewMin = glm::vec2(-std::numeric_limits<float>::infinity());
+        m_viewMax = glm::vec2(std::numeric_limits<float>::infinity());
+        return;
+    }
+
+    //unproject opposite corners of clip space to get the visible world rectangle
+    glm::mat4 inverse = glm::inverse(m_uniform.projectionMatrix * m_uniform.viewMatrix);
+    glm::vec4 corner0 = inverse * glm::vec4(-1, -1, 0, 1);
+    glm::vec4 corner1 = inverse * glm::vec4(1, 1, 0, 1);
+
+    m_viewMin = glm::min(glm::vec2(corner0), glm::vec2(corner1));
+    m_viewMax = glm::max(glm::vec2(corner0), glm::vec2(corner1));
+}
+
+bool RenderNode::isVisible(const Chunk& chunk) const {
+    return chunk.max.x >= m_viewMin.x && chunk.min.x <= m_viewMax.x
+        && chunk.max.y >= m_viewMin.y && chunk.min.y <= m_viewMax.y;
+}
+
+void RenderNode::onBake() {
+    if (m_graphics->dynamicRendering()) return;
+
+    //the render pass only differs in load/store ops and layouts, so it stays compatible with the existing pipelines
+    for (auto& framebuffer : m_framebuffers) {
+        graph().queueDestroy(std::move(framebuffer));
+    }
+
+    graph().queueDestroy(std::move(m_renderPass));
+    createRenderPass();
+}
+
 void RenderNode::recreateResources(vk::raii::SwapchainKHR* swapchain) {
-    m_renderPass.reset();
+    //frames in flight may still reference these, so they are destroyed by the render graph once those frames finish
+    for (auto& framebuffer : m_framebuffers) {
+        graph().queueDestroy(std::move(framebuffer));
+    }
+
+    m_framebuffers.clear();
 
     if (swapchain == nullptr) return;
 
-    createRenderPass();
-    createFramebuffers();
+    if (m_target->format() != m_attachmentFormat) {
+        //the builders read the format and render pass, so the worker must be idle before they change
+        m_pipelines->clear();
+        m_tileTexturePipelines->clear();
+
+        m_attachmentFormat = m_target->format();
+
+        if (!m_graphics->dynamicRendering()) {
+            graph().queueDestroy(std::move(m_renderPass));
+            createRenderPass();
+        }
+
+        m_pipelines->get(TileFeatureAll);
+        m_tileTexturePipelines->get(TileFeatureAll);
+    }
+
+    //dynamic rendering draws straight into the target image views, so it needs no framebuffers
+    if (m_graphics->dynamicRendering()) return;
+
+    //framebuffers are created on first use of each target image
+    m_framebuffers.resize(m_target->imageCount());
+}
+
+void RenderNode::onBufferRelocated(SEngine::Buffer& buffer) {
+    //edits made while the copy was in flight only reached the old location
+    if (&buffer == m_instanceBuffer.get() && m_instanceData.size() > 0) {
+        m_transferNode->transfer(buffer, m_instanceData.size() * sizeof(TileInstance), 0, m_instanceData.data());
+    } else if (&buffer == m_chunkBuffer.get() && m_chunkBounds.size() > 0) {
+        m_transferNode->transfer(buffer, m_chunkBounds.size() * sizeof(ChunkBounds), 0, m_chunkBounds.data());
+    }
+
+    //the instance buffer is bound per draw, no descriptor refers to it
+    if (&buffer == m_instanceBuffer.get()) return;
+
+    invalidateDescriptors();
+}
+
+void RenderNode::invalidateDescriptors() {
+    //frames in flight may still have the old sets bound, so each set is rewritten when its frame is next recorded
+    std::fill(m_descriptorDirty.begin(), m_descriptorDirty.end(), true);
+    std::fill(m_cullDescriptorDirty.begin(), m_cullDescriptorDirty.end(), true);
 }
 
 void RenderNode::createRenderPass() {
+    auto& attachmentInfo = m_imageUsage->attachmentInfo();
+
     vk::AttachmentDescription colorAttachment = {};
-    colorAttachment.format = m_graphics->swapchainFormat();
+    colorAttachment.format = m_target->format();
     colorAttachment.samples = vk::SampleCountFlagBits::e1;
-    colorAttachment.loadOp = vk::AttachmentLoadOp::eClear;
-    colorAttachment.storeOp = vk::AttachmentStoreOp::eStore;
+    colorAttachment.loadOp = attachmentInfo.loadOp;
+    colorAttachment.storeOp = attachmentInfo.storeOp;
     colorAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
     colorAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-    colorAttachment.initialLayout = vk::ImageLayout::eUndefined;
-    colorAttachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+    colorAttachment.initialLayout = attachmentInfo.initialLayout;
+    colorAttachment.finalLayout = attachmentInfo.finalLayout;
 
     vk::AttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -210,13 +616,11 @@ void RenderNode::createRenderPass() {
     m_renderPass = std::make_unique<vk::raii::RenderPass>(m_graphics->device(), info);
 }
 
-void RenderNode::createFramebuffers() {
-    auto& imageViews = m_graphics->swapchainImageViews();
-    m_framebuffers.clear();
+vk::raii::Framebuffer& RenderNode::getFramebuffer(uint32_t imageIndex) {
+    auto& framebuffer = m_framebuffers[imageIndex];
 
-    for (uint32_t i = 0; i < imageViews.size(); i++) {
-        vk::Format format = m_graphics->swapchainFormat();
-        vk::Extent2D extent = m_graphics->swapchainExtent();
+    if (framebuffer == nullptr) {
+        vk::Extent2D extent = m_target->extent();
 
         vk::FramebufferCreateInfo info = {};
         info.renderPass = **m_renderPass;
@@ -224,10 +628,12 @@ void RenderNode::createFramebuffers() {
         info.height = extent.height;
         info.layers = 1;
         info.attachmentCount = 1;
-        info.pAttachments = &*imageViews[i];
+        info.pAttachments = &*m_target->imageView(imageIndex);
 
-        m_framebuffers.emplace_back(m_graphics->device(), info);
+        framebuffer = std::make_unique<vk::raii::Framebuffer>(m_graphics->device(), info);
     }
+
+    return *framebuffer;
 }
 
 void RenderNode::createUniformBuffer() {
@@ -238,7 +644,24 @@ void RenderNode::createUniformBuffer() {
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-    m_uniformBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo);
+    m_uniformBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Uniform, "Camera uniform");
+    m_uniformRelocatedConnection = m_uniformBuffer->onRelocated().connect<&RenderNode::onBufferRelocated>(this);
+}
+
+void RenderNode::createIndexBuffer() {
+    //each tile quad is 4 corners shared by 2 triangles, instead of 6 vertex shader invocations
+    uint16_t indices[] = { 0, 1, 2, 1, 3, 2 };
+
+    vk::BufferCreateInfo info = {};
+    info.size = sizeof(indices);
+    info.usage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_indexBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Vertex, "Tile quad indices");
+
+    m_transferNode->transfer(*m_indexBuffer, sizeof(indices), 0, indices);
 }
 
 void RenderNode::createSampler() {
@@ -255,7 +678,7 @@ void RenderNode::createDescriptorLayout() {
     vk::DescriptorSetLayoutBinding binding0 = {};
     binding0.descriptorType = vk::DescriptorType::eUniformBuffer;
     binding0.descriptorCount = 1;
-    binding0.stageFlags = vk::ShaderStageFlagBits::eVertex;
+    binding0.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
     binding0.binding = 0;
 
     vk::DescriptorSetLayoutBinding binding1 = {};
@@ -270,49 +693,71 @@ void RenderNode::createDescriptorLayout() {
     binding2.stageFlags = vk::ShaderStageFlagBits::eFragment;
     binding2.binding = 2;
 
-    vk::DescriptorSetLayoutBinding bindings[] = { binding0, binding1, binding2 };
+    vk::DescriptorSetLayoutBinding binding3 = {};
+    binding3.descriptorType = vk::DescriptorType::eSampledImage;
+    binding3.descriptorCount = 1;
+    binding3.stageFlags = vk::ShaderStageFlagBits::eFragment;
+    binding3.binding = 3;
+
+    vk::DescriptorSetLayoutBinding binding4 = {};
+    binding4.descriptorType = vk::DescriptorType::eStorageBuffer;
+    binding4.descriptorCount = 1;
+    binding4.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+    binding4.binding = 4;
+
+    vk::DescriptorSetLayoutBinding bindings[] = { binding0, binding1, binding2, binding3, binding4 };
 
     vk::DescriptorSetLayoutCreateInfo info = {};
-    info.bindingCount = 3;
+    info.bindingCount = 5;
     info.pBindings = bindings;
 
     m_descriptorLayout = std::make_unique<vk::raii::DescriptorSetLayout>(m_graphics->device(), info);
 }
 
 void RenderNode::createDescriptorPool() {
+    //one set per frame in flight, so a set is never rewritten while a frame still uses it
+    uint32_t framesInFlight = graph().framesInFlight();
+
     vk::DescriptorPoolSize poolSize0 = {};
-    poolSize0.descriptorCount = 1;
+    poolSize0.descriptorCount = framesInFlight;
     poolSize0.type = vk::DescriptorType::eUniformBuffer;
 
     vk::DescriptorPoolSize poolSize1 = {};
-    poolSize1.descriptorCount = 1;
+    poolSize1.descriptorCount = framesInFlight;
     poolSize1.type = vk::DescriptorType::eSampler;
 
     vk::DescriptorPoolSize poolSize2 = {};
-    poolSize2.descriptorCount = 1;
+    poolSize2.descriptorCount = 2 * framesInFlight;
     poolSize2.type = vk::DescriptorType::eSampledImage;
 
-    vk::DescriptorPoolSize poolSizes[] = { poolSize0, poolSize1, poolSize2 };
+    vk::DescriptorPoolSize poolSize3 = {};
+    poolSize3.descriptorCount = framesInFlight;
+    poolSize3.type = vk::DescriptorType::eStorageBuffer;
+
+    vk::DescriptorPoolSize poolSizes[] = { poolSize0, poolSize1, poolSize2, poolSize3 };
 
     vk::DescriptorPoolCreateInfo info = {};
-    info.maxSets = 1;
-    info.poolSizeCount = 3;
+    info.maxSets = framesInFlight;
+    info.poolSizeCount = 4;
     info.pPoolSizes = poolSizes;
 
     m_descriptorPool = std::make_unique<vk::raii::DescriptorPool>(m_graphics->device(), info);
 }
 
-void RenderNode::createDescriptor() {
+void RenderNode::createDescriptors() {
+    uint32_t framesInFlight = graph().framesInFlight();
+    std::vector<vk::DescriptorSetLayout> layouts(framesInFlight, **m_descriptorLayout);
+
     vk::DescriptorSetAllocateInfo info = {};
     info.descriptorPool = **m_descriptorPool;
-    info.descriptorSetCount = 1;
-    info.pSetLayouts = &**m_descriptorLayout;
+    info.descriptorSetCount = framesInFlight;
+    info.pSetLayouts = layouts.data();
 
-    auto descriptors = (*m_graphics->device()).allocateDescriptorSets(info);
-    m_descriptor = std::make_unique<vk::DescriptorSet>(std::move(descriptors[0]));
+    m_descriptors = (*m_graphics->device()).allocateDescriptorSets(info);
+    m_descriptorDirty.assign(framesInFlight, true);
 }
 
-void RenderNode::updateDescriptor() {
+void RenderNode::updateDescriptor(uint32_t frame) {
     vk::DescriptorBufferInfo bufferInfo = {};
     bufferInfo.buffer = m_uniformBuffer->buffer();
     bufferInfo.range = m_uniformBuffer->size();
@@ -320,7 +765,7 @@ void RenderNode::updateDescriptor() {
     vk::WriteDescriptorSet write0 = {};
     write0.descriptorCount = 1;
     write0.descriptorType = vk::DescriptorType::eUniformBuffer;
-    write0.dstSet = *m_descriptor;
+    write0.dstSet = m_descriptors[frame];
     write0.dstBinding = 0;
     write0.pBufferInfo = &bufferInfo;
 
@@ -330,22 +775,146 @@ void RenderNode::updateDescriptor() {
     vk::WriteDescriptorSet write1 = {};
     write1.descriptorCount = 1;
     write1.descriptorType = vk::DescriptorType::eSampler;
-    write1.dstSet = *m_descriptor;
+    write1.dstSet = m_descriptors[frame];
     write1.dstBinding = 1;
     write1.pImageInfo = &samplerInfo;
 
     vk::DescriptorImageInfo imageInfo = {};
-    imageInfo.imageView = *m_spritesheetViews[0];
+    imageInfo.imageView = **m_spritesheetView;
     imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
 
     vk::WriteDescriptorSet write2 = {};
     write2.descriptorCount = 1;
     write2.descriptorType = vk::DescriptorType::eSampledImage;
-    write2.dstSet = *m_descriptor;
+    write2.dstSet = m_descriptors[frame];
     write2.dstBinding = 2;
     write2.pImageInfo = &imageInfo;
 
-    m_graphics->device().updateDescriptorSets({ write0, write1, write2 }, nullptr);
+    vk::DescriptorBufferInfo animationInfo = {};
+    animationInfo.buffer = m_animationBuffer->buffer();
+    animationInfo.range = m_animationBuffer->size();
+
+    vk::WriteDescriptorSet write4 = {};
+    write4.descriptorCount = 1;
+    write4.descriptorType = vk::DescriptorType::eStorageBuffer;
+    write4.dstSet = m_descriptors[frame];
+    write4.dstBinding = 4;
+    write4.pBufferInfo = &animationInfo;
+
+    m_graphics->device().updateDescriptorSets({ write0, write1, write2, write4 }, nullptr);
+
+    if (m_tileImageView == nullptr) return;
+
+    vk::DescriptorImageInfo tileImageInfo = {};
+    tileImageInfo.imageView = **m_tileImageView;
+    tileImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    vk::WriteDescriptorSet write3 = {};
+    write3.descriptorCount = 1;
+    write3.descriptorType = vk::DescriptorType::eSampledImage;
+    write3.dstSet = m_descriptors[frame];
+    write3.dstBinding = 3;
+    write3.pImageInfo = &tileImageInfo;
+
+    m_graphics->device().updateDescriptorSets(write3, nullptr);
+}
+
+void RenderNode::createCullDescriptors() {
+    vk::DescriptorSetLayoutBinding binding0 = {};
+    binding0.descriptorType = vk::DescriptorType::eStorageBuffer;
+    binding0.descriptorCount = 1;
+    binding0.stageFlags = vk::ShaderStageFlagBits::eCompute;
+    binding0.binding = 0;
+
+    vk::DescriptorSetLayoutBinding binding1 = {};
+    binding1.descriptorType = vk::DescriptorType::eStorageBuffer;
+    binding1.descriptorCount = 1;
+    binding1.stageFlags = vk::ShaderStageFlagBits::eCompute;
+    binding1.binding = 1;
+
+    vk::DescriptorSetLayoutBinding bindings[] = { binding0, binding1 };
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+
+    m_cullDescriptorLayout = std::make_unique<vk::raii::DescriptorSetLayout>(m_graphics->device(), layoutInfo);
+
+    //one set per frame in flight, each pointing at that frame's slice of the draw buffer
+    uint32_t framesInFlight = graph().framesInFlight();
+
+    vk::DescriptorPoolSize poolSize = {};
+    poolSize.descriptorCount = 2 * framesInFlight;
+    poolSize.type = vk::DescriptorType::eStorageBuffer;
+
+    vk::DescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.maxSets = framesInFlight;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    m_cullDescriptorPool = std::make_unique<vk::raii::DescriptorPool>(m_graphics->device(), poolInfo);
+
+    std::vector<vk::DescriptorSetLayout> layouts(framesInFlight, **m_cullDescriptorLayout);
+
+    vk::DescriptorSetAllocateInfo info = {};
+    info.descriptorPool = **m_cullDescriptorPool;
+    info.descriptorSetCount = framesInFlight;
+    info.pSetLayouts = layouts.data();
+
+    m_cullDescriptors = (*m_graphics->device()).allocateDescriptorSets(info);
+    m_cullDescriptorDirty.assign(framesInFlight, true);
+}
+
+void RenderNode::updateCullDescriptor(uint32_t frame) {
+    vk::DescriptorBufferInfo chunkInfo = {};
+    chunkInfo.buffer = m_chunkBuffer->buffer();
+    chunkInfo.range = m_chunkBuffer->size();
+
+    vk::WriteDescriptorSet write0 = {};
+    write0.descriptorCount = 1;
+    write0.descriptorType = vk::DescriptorType::eStorageBuffer;
+    write0.dstSet = m_cullDescriptors[frame];
+    write0.dstBinding = 0;
+    write0.pBufferInfo = &chunkInfo;
+
+    vk::DescriptorBufferInfo drawInfo = {};
+    drawInfo.buffer = m_drawBuffer->buffer();
+    drawInfo.offset = frame * m_drawStride;
+    drawInfo.range = m_drawStride;
+
+    vk::WriteDescriptorSet write1 = {};
+    write1.descriptorCount = 1;
+    write1.descriptorType = vk::DescriptorType::eStorageBuffer;
+    write1.dstSet = m_cullDescriptors[frame];
+    write1.dstBinding = 1;
+    write1.pBufferInfo = &drawInfo;
+
+    m_graphics->device().updateDescriptorSets({ write0, write1 }, nullptr);
+}
+
+void RenderNode::createCullPipeline() {
+    vk::PushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstants);
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &**m_cullDescriptorLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    m_cullPipelineLayout = std::make_unique<vk::raii::PipelineLayout>(m_graphics->device(), pipelineLayoutInfo);
+
+    auto shader = createShader("shaders/cull.comp.spv");
+
+    vk::ComputePipelineCreateInfo info = {};
+    info.stage.stage = vk::ShaderStageFlagBits::eCompute;
+    info.stage.module = *shader;
+    info.stage.pName = "main";
+    info.layout = **m_cullPipelineLayout;
+
+    m_cullPipeline = std::make_unique<vk::raii::Pipeline>(m_graphics->device(), m_graphics->pipelineCache(), info);
 }
 
 vk::raii::ShaderModule RenderNode::createShader(const std::string& filename) {
@@ -358,36 +927,80 @@ vk::raii::ShaderModule RenderNode::createShader(const std::string& filename) {
     return vk::raii::ShaderModule(m_graphics->device(), info);
 }
 
-void RenderNode::createPipeline() {
-    auto vertexShader = createShader("shaders/triangle.vert.spv");
-    auto fragmentShader = createShader("shaders/triangle.frag.spv");
+void RenderNode::createPipelineLayout() {
+    vk::PushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(LayerPushConstants);
 
-    vk::PipelineShaderStageCreateInfo vertexStage = {};
-    vertexStage.stage = vk::ShaderStageFlagBits::eVertex;
-    vertexStage.module = *vertexShader;
-    vertexStage.pName = "main";
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &**m_descriptorLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    vk::PipelineShaderStageCreateInfo fragmentStage = {};
-    fragmentStage.stage = vk::ShaderStageFlagBits::eFragment;
-    fragmentStage.module = *fragmentShader;
-    fragmentStage.pName = "main";
+    m_pipelineLayout = std::make_unique<vk::raii::PipelineLayout>(m_graphics->device(), pipelineLayoutInfo);
+}
 
-    std::array<vk::PipelineShaderStageCreateInfo, 2> stages = { vertexStage, fragmentStage };
+void RenderNode::createPipelines() {
+    m_pipelines = std::make_unique<SEngine::PipelineVariants>(graph(), TileFeatureCount, [this](const vk::SpecializationInfo& specialization) {
+        return createInstancePipeline(specialization);
+    });
+
+    m_tileTexturePipelines = std::make_unique<SEngine::PipelineVariants>(graph(), TileFeatureCount, [this](const vk::SpecializationInfo& specialization) {
+        return createTileTexturePipeline(specialization);
+    });
+
+    //the variant with every feature enabled can draw any map, so it is built up front and stands in for the others
+    m_pipelines->get(TileFeatureAll);
+    m_tileTexturePipelines->get(TileFeatureAll);
+}
+
+vk::raii::Pipeline& RenderNode::getPipeline(SEngine::PipelineVariants& variants) {
+    vk::raii::Pipeline* pipeline = variants.tryGet(m_features);
+    if (pipeline != nullptr) return *pipeline;
+
+    return variants.get(TileFeatureAll);
+}
+
+uint32_t RenderNode::mapFeatures() const {
+    uint32_t features = 0;
+
+    if (m_animated) {
+        features |= TileFeatureAnimation;
+    }
+
+    for (auto& layer : m_map->layers) {
+        //OR the raw GIDs together so the scan has no early exit in its inner loop and vectorizes
+        uint32_t flags = 0;
 
+        for (auto& data : layer.data) {
+            flags |= data.raw;
+        }
+
+        if ((flags & Tiled::LayerData::FlipMask) != 0) {
+            return features | TileFeatureFlip;
+        }
+    }
+
+    return features;
+}
+
+std::unique_ptr<vk::raii::Pipeline> RenderNode::createInstancePipeline(const vk::SpecializationInfo& specialization) {
     vk::VertexInputBindingDescription bindingDescription = {};
     bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex);
-    bindingDescription.inputRate = vk::VertexInputRate::eVertex;
+    bindingDescription.stride = sizeof(TileInstance);
+    bindingDescription.inputRate = vk::VertexInputRate::eInstance;
 
     std::array<vk::VertexInputAttributeDescription, 2> attributeDescriptions = {};
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = vk::Format::eR32G32B32Sfloat;
-    attributeDescriptions[0].offset = offsetof(Vertex, pos);
+    attributeDescriptions[0].format = vk::Format::eR16G16Sint;
+    attributeDescriptions[0].offset = offsetof(TileInstance, x);
     attributeDescriptions[1].binding = 0;
     attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = vk::Format::eR32G32B32Sfloat;;
-    attributeDescriptions[1].offset = offsetof(Vertex, uv);
+    attributeDescriptions[1].format = vk::Format::eR16G16Uint;
+    attributeDescriptions[1].offset = offsetof(TileInstance, layer);
 
     vk::PipelineVertexInputStateCreateInfo vertexInput = {};
     vertexInput.vertexBindingDescriptionCount = 1;
@@ -395,6 +1008,35 @@ void RenderNode::createPipeline() {
     vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInput.pVertexAttributeDescriptions = attributeDescriptions.data();
 
+    return createPipeline("shaders/triangle.vert.spv", "shaders/triangle.frag.spv", vertexInput, specialization);
+}
+
+std::unique_ptr<vk::raii::Pipeline> RenderNode::createTileTexturePipeline(const vk::SpecializationInfo& specialization) {
+    //tile image mode generates its quads from gl_VertexIndex
+    vk::PipelineVertexInputStateCreateInfo emptyVertexInput = {};
+
+    return createPipeline("shaders/tilemap.vert.spv", "shaders/tilemap.frag.spv", emptyVertexInput, specialization);
+}
+
+//may run on the PipelineVariants worker thread, so it only reads state that is stable while the worker is busy
+std::unique_ptr<vk::raii::Pipeline> RenderNode::createPipeline(const std::string& vertexShaderName, const std::string& fragmentShaderName, const vk::PipelineVertexInputStateCreateInfo& vertexInput, const vk::SpecializationInfo& specialization) {
+    auto vertexShader = createShader(vertexShaderName);
+    auto fragmentShader = createShader(fragmentShaderName);
+
+    vk::PipelineShaderStageCreateInfo vertexStage = {};
+    vertexStage.stage = vk::ShaderStageFlagBits::eVertex;
+    vertexStage.module = *vertexShader;
+    vertexStage.pName = "main";
+    vertexStage.pSpecializationInfo = &specialization;
+
+    vk::PipelineShaderStageCreateInfo fragmentStage = {};
+    fragmentStage.stage = vk::ShaderStageFlagBits::eFragment;
+    fragmentStage.module = *fragmentShader;
+    fragmentStage.pName = "main";
+    fragmentStage.pSpecializationInfo = &specialization;
+
+    std::array<vk::PipelineShaderStageCreateInfo, 2> stages = { vertexStage, fragmentStage };
+
     vk::PipelineInputAssemblyStateCreateInfo inputAssembly = {};
     inputAssembly.topology = vk::PrimitiveTopology::eTriangleList;
 
@@ -438,12 +1080,6 @@ void RenderNode::createPipeline() {
     vk::PipelineMultisampleStateCreateInfo multisample = {};
     multisample.rasterizationSamples = vk::SampleCountFlagBits::e1;
 
-    vk::PipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &**m_descriptorLayout;
-
-    m_pipelineLayout = std::make_unique<vk::raii::PipelineLayout>(m_graphics->device(), pipelineLayoutInfo);
-
     vk::GraphicsPipelineCreateInfo info = {};
     info.stageCount = 2;
     info.pStages = stages.data();
@@ -455,66 +1091,375 @@ void RenderNode::createPipeline() {
     info.pDynamicState = &dynamicState;
     info.pMultisampleState = &multisample;
     info.layout = **m_pipelineLayout;
+
+#ifdef VK_KHR_dynamic_rendering
+    vk::PipelineRenderingCreateInfoKHR renderingInfo = {};
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &m_attachmentFormat;
+
+    if (m_graphics->dynamicRendering()) {
+        info.pNext = &renderingInfo;
+    } else {
+        info.renderPass = **m_renderPass;
+    }
+#else
     info.renderPass = **m_renderPass;
+#endif
 
-    m_pipeline = std::make_unique<vk::raii::Pipeline>(m_graphics->device(), nullptr, info);
+    return std::make_unique<vk::raii::Pipeline>(m_graphics->device(), m_graphics->pipelineCache(), info);
 }
 
-void RenderNode::createVertexData() {
+void RenderNode::createInstanceData() {
+    //lay out every chunk's slots first, so the chunks can then be filled in parallel without sharing anything
+    size_t chunkCount = 0;
+
     for (auto& layer : m_map->layers) {
-        for (int32_t y = 0; y < layer.height; y++) {
-            for (int32_t x = 0; x < layer.width; x++) {
-                glm::vec3 offset = { x, y, 0 };
+        size_t chunksX = (layer.width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        size_t chunksY = (layer.height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        chunkCount += chunksX * chunksY;
+    }
 
-                int32_t index = (y * layer.width) + x;
-                int32_t id = layer.data[index].id - 1;
-                int32_t depth = layer.id;
+    m_chunks.reserve(chunkCount);
+    m_layerChunks.reserve(m_map->layers.size());
+    uint32_t instanceCount = 0;
 
-                if (id < 0) {
-                    continue;
-                }
+    for (size_t i = 0; i < m_map->layers.size(); i++) {
+        auto& layer = m_map->layers[i];
+        m_layerChunks.push_back(static_cast<uint32_t>(m_chunks.size()));
 
-                Vertex v1 = {
-                    glm::vec3{ 0, 0, depth } + offset,
-                    glm::vec3{ 0, 0, id }
-                };
+        for (int32_t chunkY = 0; chunkY < layer.height; chunkY += CHUNK_SIZE) {
+            for (int32_t chunkX = 0; chunkX < layer.width; chunkX += CHUNK_SIZE) {
+                int32_t endX = std::min(chunkX + CHUNK_SIZE, layer.width);
+                int32_t endY = std::min(chunkY + CHUNK_SIZE, layer.height);
 
-                Vertex v2 = {
-                    glm::vec3{ 1, 0, depth } + offset,
-                    glm::vec3{ 1, 0, id }
-                };
+                Chunk chunk = {};
+                chunk.min = { chunkX, chunkY };
+                chunk.max = { endX, endY };
+                chunk.layer = static_cast<uint32_t>(i);
+                chunk.firstInstance = instanceCount;
+                chunk.capacity = static_cast<uint32_t>((endX - chunkX) * (endY - chunkY));
 
-                Vertex v3 = {
-                    glm::vec3{ 0, 1, depth } + offset,
-                    glm::vec3{ 0, 1, id }
-                };
+                instanceCount += chunk.capacity;
+                m_chunks.push_back(chunk);
+            }
+        }
+    }
 
-                Vertex v4 = {
-                    glm::vec3{ 1, 1, depth } + offset,
-                    glm::vec3{ 1, 1, id }
-                };
+    m_instanceData.resize(instanceCount);
+
+    m_engine->threadPool().parallelFor(m_chunks.size(), [this](size_t i) {
+        buildChunk(m_chunks[i]);
+    });
+
+    m_chunkDirty.assign(m_chunks.size(), false);
+}
 
-                m_vertexData.push_back(v1);
-                m_vertexData.push_back(v2);
-                m_vertexData.push_back(v3);
+void RenderNode::buildChunk(Chunk& chunk) {
+    auto& layer = m_map->layers[chunk.layer];
+    int32_t startX = static_cast<int32_t>(chunk.min.x);
+    int32_t startY = static_cast<int32_t>(chunk.min.y);
+    int32_t endX = static_cast<int32_t>(chunk.max.x);
+    int32_t endY = static_cast<int32_t>(chunk.max.y);
 
-                m_vertexData.push_back(v2);
-                m_vertexData.push_back(v4);
-                m_vertexData.push_back(v3);
+    TileInstance* instances = &m_instanceData[chunk.firstInstance];
+    uint32_t count = 0;
+
+    for (int32_t y = startY; y < endY; y++) {
+        for (int32_t x = startX; x < endX; x++) {
+            int32_t index = (y * layer.width) + x;
+            auto& datum = layer.data[index];
+            int32_t id = static_cast<int32_t>(datum.id()) - 1;
+
+            if (id < 0) {
+                continue;
             }
+
+            //the instance keeps the flip bits in the same order as the GID, shifted into its top 3 bits
+            uint16_t flags = static_cast<uint16_t>((datum.raw & Tiled::LayerData::FlipMask) >> 16);
+
+            TileInstance& instance = instances[count];
+            instance.x = static_cast<int16_t>(x);
+            instance.y = static_cast<int16_t>(y);
+            instance.layer = static_cast<uint16_t>((layer.id & 0x1FFF) | flags);
+            instance.tile = static_cast<uint16_t>(id);
+
+            count++;
         }
     }
+
+    chunk.instanceCount = count;
 }
 
-void RenderNode::createVertexBuffer() {
+void RenderNode::createInstanceBuffer() {
     vk::BufferCreateInfo info = {};
-    info.size = m_vertexData.size() * sizeof(Vertex);
+    info.size = m_instanceData.size() * sizeof(TileInstance);
     info.usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst;
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-    m_vertexBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo);
+    m_instanceBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Vertex, "Map tiles");
+    m_instanceRelocatedConnection = m_instanceBuffer->onRelocated().connect<&RenderNode::onBufferRelocated>(this);
+
+    m_transferNode->transfer(*m_instanceBuffer, m_instanceData.size() * sizeof(TileInstance), 0, m_instanceData.data());
+}
+
+void RenderNode::createChunkBuffers() {
+    m_chunkBounds.resize(m_chunks.size());
+
+    for (size_t i = 0; i < m_chunks.size(); i++) {
+        auto& chunk = m_chunks[i];
+        auto& bounds = m_chunkBounds[i];
+
+        bounds = {};
+        bounds.min = chunk.min;
+        bounds.max = chunk.max;
+        bounds.firstInstance = chunk.firstInstance;
+        bounds.instanceCount = chunk.instanceCount;
+    }
+
+    //an empty map still needs a valid buffer to bind
+    vk::BufferCreateInfo info = {};
+    info.size = std::max<size_t>(m_chunkBounds.size(), 1) * sizeof(ChunkBounds);
+    info.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_chunkBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Other, "Chunk bounds");
+    m_chunkRelocatedConnection = m_chunkBuffer->onRelocated().connect<&RenderNode::onBufferRelocated>(this);
+
+    if (m_chunkBounds.size() > 0) {
+        m_transferNode->transfer(*m_chunkBuffer, m_chunkBounds.size() * sizeof(ChunkBounds), 0, m_chunkBounds.data());
+    }
+
+    //each frame's slice starts with the draw count, and must start at a valid storage buffer offset
+    vk::DeviceSize alignment = m_graphics->physicalDevice().getProperties().limits.minStorageBufferOffsetAlignment;
+    vk::DeviceSize size = sizeof(uint32_t) + (m_chunks.size() * sizeof(vk::DrawIndexedIndirectCommand));
+    m_drawStride = ((size + alignment - 1) / alignment) * alignment;
+
+    vk::BufferCreateInfo drawInfo = {};
+    drawInfo.size = m_drawStride * graph().framesInFlight();
+    drawInfo.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer;
+
+    m_drawBuffer = std::make_unique<SEngine::Buffer>(*m_engine, drawInfo, allocInfo, SEngine::MemoryCategory::Other, "Chunk draw commands");
+    m_drawRelocatedConnection = m_drawBuffer->onRelocated().connect<&RenderNode::onBufferRelocated>(this);
+}
+
+void RenderNode::createSpritesheet() {
+    if (m_map->tilesets.size() == 0) throw std::runtime_error("Map has no tilesets");
+
+    //every tileset is packed into one array texture, with tile GID N stored in array layer N - 1
+    int32_t tileWidth = m_map->tilesets[0].tileWidth;
+    int32_t tileHeight = m_map->tilesets[0].tileHeight;
+    uint32_t layerCount = 0;
+
+    for (auto& tileset : m_map->tilesets) {
+        if (tileset.tileWidth != tileWidth || tileset.tileHeight != tileHeight) {
+            throw std::runtime_error("All tilesets must have the same tile size");
+        }
+
+        layerCount = std::max(layerCount, static_cast<uint32_t>(tileset.firstGID - 1 + tileset.tileCount));
+    }
+
+    uint32_t maxLayers = m_graphics->physicalDevice().getProperties().limits.maxImageArrayLayers;
+    if (layerCount > maxLayers || layerCount > std::numeric_limits<uint16_t>::max() + 1u) {
+        throw std::runtime_error("Too many tiles in map tilesets");
+    }
+
+    vk::Format format = vk::Format::eR8G8B8A8Srgb;
+
+    vk::Extent3D tileExtent = {
+        static_cast<uint32_t>(tileWidth),
+        static_cast<uint32_t>(tileHeight),
+        1
+    };
+
+    vk::ImageCreateInfo info = {};
+    info.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
+    info.imageType = vk::ImageType::e2D;
+    info.format = format;
+    info.extent = tileExtent;
+    info.arrayLayers = layerCount;
+    info.mipLevels = 1;
+    info.samples = vk::SampleCountFlagBits::e1;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_spritesheet = std::make_unique<SEngine::Image>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Texture, "Map tilesets");
+
+    for (auto& tileset : m_map->tilesets) {
+        SEngine::ImageAsset asset = SEngine::readImage("data/" + tileset.image);
+        int32_t extendedImageWidth = tileset.imageWidth - (2 * tileset.margin) + tileset.spacing;
+        int32_t extendedImageHeight = tileset.imageHeight - (2 * tileset.margin) + tileset.spacing;
+        int32_t tileStepX = tileset.tileWidth + tileset.spacing;
+        int32_t tileStepY = tileset.tileHeight + tileset.spacing;
+
+        int32_t tileCountX = extendedImageWidth / tileStepX;
+        int32_t tileCountY = extendedImageHeight / tileStepY;
+
+        std::vector<vk::BufferImageCopy> copies;
+        uint32_t tileIndex = 0;
+
+        for (int32_t y = 0; y < tileCountY; y++) {
+            for (int32_t x = 0; x < tileCountX; x++) {
+                if (tileIndex >= static_cast<uint32_t>(tileset.tileCount)) break;
+
+                glm::ivec2 tileOffset = {
+                    tileset.margin + x * tileStepX,
+                    tileset.margin + y * tileStepY
+                };
+
+                vk::BufferImageCopy copy = {};
+                copy.imageExtent = tileExtent;
+                copy.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+                copy.imageSubresource.baseArrayLayer = tileset.firstGID - 1 + tileIndex;
+                copy.imageSubresource.layerCount = 1;
+                copy.imageSubresource.mipLevel = 0;
+                copy.bufferOffset = (((size_t)tileset.imageWidth * tileOffset.y) + (tileOffset.x)) * SEngine::getFormatSize(format);
+
+                copies.push_back(copy);
+                tileIndex++;
+            }
+        }
+
+        vk::Extent3D totalExtent = {
+            static_cast<uint32_t>(tileset.imageWidth),
+            static_cast<uint32_t>(tileset.imageHeight),
+            1
+        };
+
+        m_transferNode->transfer(*m_spritesheet, format, copies, totalExtent, asset.data());
+    }
+
+    vk::ImageViewCreateInfo viewInfo = {};
+    viewInfo.image = m_spritesheet->image();
+    viewInfo.format = format;
+    viewInfo.viewType = vk::ImageViewType::e2DArray;
+    viewInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = layerCount;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+
+    m_spritesheetView = std::make_unique<vk::raii::ImageView>(m_graphics->device(), viewInfo);
+}
+
+void RenderNode::createAnimationData() {
+    //static tiles get a zero frame count, so the shaders only pay for a lookup
+    uint32_t layerCount = m_spritesheet->arrayLayers();
+
+    m_animationData.clear();
+    m_animationData.resize(layerCount, glm::uvec2(0));
+    m_animated = false;
+
+    for (auto& tileset : m_map->tilesets) {
+        for (auto& tile : tileset.tiles) {
+            if (tile.animation.empty()) continue;
+
+            uint32_t layer = static_cast<uint32_t>(tileset.firstGID - 1 + tile.id);
+            if (layer >= layerCount) throw std::runtime_error("Animated tile out of range");
+            uint32_t firstFrame = static_cast<uint32_t>(m_animationData.size());
+            uint32_t time = 0;
+
+            for (auto& frame : tile.animation) {
+                //frame IDs come straight from the map file, a bad one would index past the spritesheet in the shaders
+                if (frame.tileID < 0 || frame.tileID >= tileset.tileCount) throw std::runtime_error("Animation frame out of range");
+                uint32_t frameLayer = static_cast<uint32_t>(tileset.firstGID - 1 + frame.tileID);
+                if (frameLayer >= layerCount) throw std::runtime_error("Animation frame out of range");
+
+                time += static_cast<uint32_t>(std::max(frame.duration, 1));
+                m_animationData.push_back({ frameLayer, time });
+            }
+
+            m_animationData[layer] = { firstFrame, static_cast<uint32_t>(tile.animation.size()) };
+            m_animated = true;
+        }
+    }
+
+    vk::BufferCreateInfo info = {};
+    info.size = m_animationData.size() * sizeof(glm::uvec2);
+    info.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_animationBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Other, "Tile animations");
+    m_animationRelocatedConnection = m_animationBuffer->onRelocated().connect<&RenderNode::onBufferRelocated>(this);
+
+    m_transferNode->transfer(*m_animationBuffer, info.size, 0, m_animationData.data());
+}
+
+void RenderNode::createTileImage() {
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    for (auto& layer : m_map->layers) {
+        width = std::max(width, static_cast<uint32_t>(layer.width));
+        height = std::max(height, static_cast<uint32_t>(layer.height));
+    }
+
+    uint32_t layerCount = static_cast<uint32_t>(m_map->layers.size());
+    if (width == 0 || height == 0 || layerCount == 0) return;
+
+    m_tileImageExtent = { width, height, 1 };
+    m_dirtyLayers.assign(layerCount, {});
+
+    //each texel is the raw Tiled GID, flip bits included
+    m_tileIDs.assign((size_t)width * height * layerCount, 0);
+
+    //filled in blocks of rows, each block writes a disjoint part of m_tileIDs
+    uint32_t blocksPerLayer = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    m_engine->threadPool().parallelFor((size_t)blocksPerLayer * layerCount, [&](size_t block) {
+        uint32_t i = static_cast<uint32_t>(block / blocksPerLayer);
+        auto& layer = m_map->layers[i];
+        size_t layerOffset = (size_t)width * height * i;
+        int32_t startY = static_cast<int32_t>(block % blocksPerLayer) * CHUNK_SIZE;
+        int32_t endY = std::min(startY + CHUNK_SIZE, layer.height);
+
+        //layer data already holds raw GIDs, so each row is copied as is
+        for (int32_t y = startY; y < endY; y++) {
+            memcpy(&m_tileIDs[layerOffset + ((size_t)y * width)], &layer.data[(size_t)y * layer.width], layer.width * sizeof(uint32_t));
+        }
+    });
+
+    vk::Format format = vk::Format::eR32Uint;
+
+    vk::ImageCreateInfo info = {};
+    info.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
+    info.imageType = vk::ImageType::e2D;
+    info.format = format;
+    info.extent = m_tileImageExtent;
+    info.arrayLayers = layerCount;
+    info.mipLevels = 1;
+    info.samples = vk::SampleCountFlagBits::e1;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_tileImage = std::make_unique<SEngine::Image>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Texture, "Map tile IDs");
+
+    for (uint32_t i = 0; i < layerCount; i++) {
+        vk::ImageSubresourceLayers subresourceLayers = {};
+        subresourceLayers.aspectMask = vk::ImageAspectFlagBits::eColor;
+        subresourceLayers.baseArrayLayer = i;
+        subresourceLayers.layerCount = 1;
+
+        size_t layerOffset = (size_t)width * height * i;
+        m_transferNode->transfer(*m_tileImage, {}, m_tileImageExtent, subresourceLayers, &m_tileIDs[layerOffset]);
+    }
+
+    vk::ImageViewCreateInfo viewInfo = {};
+    viewInfo.image = m_tileImage->image();
+    viewInfo.format = format;
+    viewInfo.viewType = vk::ImageViewType::e2DArray;
+    viewInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = layerCount;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
 
-    m_transferNode->transfer(*m_vertexBuffer, m_vertexData.size() * sizeof(Vertex), 0, m_vertexData.data());
+    m_tileImageView = std::make_unique<vk::raii::ImageView>(m_graphics->device(), viewInfo);
 }
\ No newline at end of file
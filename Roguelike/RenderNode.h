@@ -2,86 +2,233 @@
 
 #include <SimpleEngine/SimpleEngine.h>
 #include <SimpleEngine/RenderGraph/RenderGraph.h>
-#include <SimpleEngine/RenderGraph/AcquireNode.h>
 #include <SimpleEngine/RenderGraph/TransferNode.h>
 #include <entt/signal/sigh.hpp>
 #include <glm/glm.hpp>
+#include <SimpleEngine/PipelineVariants.h>
 
 #include "Tiled/TiledReader.h"
+#include "RenderTarget.h"
 
 class RenderNode : public SEngine::RenderGraph::Node {
 public:
-    RenderNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, SEngine::AcquireNode& acquireNode, SEngine::TransferNode& transferNode);
+    //Instances builds one quad per tile on the CPU
+    //TileTexture uploads each layer as a tile ID image and resolves tiles in the fragment shader
+    enum class TileRenderMode {
+        Instances,
+        TileTexture
+    };
+
+    struct TileChange {
+        size_t layer;
+        int32_t x;
+        int32_t y;
+        uint32_t gid;
+    };
+
+    RenderNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, RenderTarget& target, SEngine::TransferNode& transferNode);
 
     void setCamera(SEngine::Camera& camera);
-    void loadMap(Tiled::Tileset& tileset, Tiled::Map& map);
+    void setRenderMode(TileRenderMode mode);
+    //replaces any previously loaded map
+    void loadMap(Tiled::Map& map);
+
+    //changes are applied to the map immediately and uploaded to the GPU in the next preRender.
+    //throws std::runtime_error without a map, std::out_of_range for a layer, position or GID outside the loaded map
+    void setTile(size_t layer, int32_t x, int32_t y, uint32_t gid);
+    void setTiles(const std::vector<TileChange>& changes);
 
     SEngine::RenderGraph::BufferUsage& bufferUsage() { return *m_bufferUsage; }
+    SEngine::RenderGraph::BufferUsage& computeUsage() { return *m_computeUsage; }
     SEngine::RenderGraph::ImageUsage& imageUsage() { return *m_imageUsage; }
     SEngine::RenderGraph::ImageUsage& textureUsage() { return *m_textureUsage; }
+    vk::raii::ImageView& spritesheetView() const { return *m_spritesheetView; }
 
     void preRender(uint32_t currentFrame);
     void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
     void postRender(uint32_t currentFrame) {}
+    void onBake();
+    bool isDirty() const;
 
 
 private:
-    struct Vertex {
-        glm::vec3 pos;
-        glm::vec3 uv;
+    //specialization constants of the tile shaders, bit N is constant_id N
+    enum TileFeatures : uint32_t {
+        TileFeatureFlip = 1,
+        TileFeatureAnimation = 2,
+        TileFeatureCount = 2,
+        TileFeatureAll = (1 << TileFeatureCount) - 1
+    };
+
+    //layer holds the layer depth in the low 13 bits and the Tiled flip bits (x, y, diagonal) in the top 3 bits
+    struct TileInstance {
+        int16_t x;
+        int16_t y;
+        uint16_t layer;
+        uint16_t tile;
+    };
+
+    struct LayerPushConstants {
+        glm::ivec2 size;
+        uint32_t layer;
+        float depth;
+    };
+
+    //each chunk owns capacity slots in the instance buffer, with the non empty tiles packed at the front
+    struct Chunk {
+        glm::vec2 min;
+        glm::vec2 max;
+        uint32_t layer;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+        uint32_t capacity;
+    };
+
+    //GPU copy of a chunk's bounds and instance range, read by the cull pass
+    struct ChunkBounds {
+        glm::vec2 min;
+        glm::vec2 max;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+        uint32_t padding[2];
+    };
+
+    struct CullPushConstants {
+        glm::vec2 viewMin;
+        glm::vec2 viewMax;
+        uint32_t chunkCount;
+        uint32_t compact;   //pack visible chunks at the front and write the draw count
+    };
+
+    struct DirtyRegion {
+        bool dirty;
+        glm::ivec2 min;
+        glm::ivec2 max;
     };
 
     SEngine::Engine* m_engine;
     SEngine::Graphics* m_graphics;
-    SEngine::AcquireNode* m_acquireNode;
+    RenderTarget* m_target;
     SEngine::TransferNode* m_transferNode;
     SEngine::Camera* m_camera;
     Tiled::Map* m_map;
+    TileRenderMode m_renderMode;
+    uint32_t m_features;
 
     std::unique_ptr<SEngine::RenderGraph::ImageUsage> m_textureUsage;
 
-    std::vector<SEngine::Image> m_spritesheets;
-    std::vector<vk::raii::ImageView> m_spritesheetViews;
-    std::vector<Vertex> m_vertexData;
+    std::unique_ptr<SEngine::Image> m_spritesheet;
+    std::unique_ptr<vk::raii::ImageView> m_spritesheetView;
+    std::vector<TileInstance> m_instanceData;
+    std::vector<Chunk> m_chunks;
+    std::vector<uint32_t> m_layerChunks;
+    std::vector<uint32_t> m_dirtyChunks;
+    std::vector<bool> m_chunkDirty;
+    std::vector<DirtyRegion> m_dirtyLayers;
+    std::vector<uint32_t> m_tileScratch;
+    std::vector<ChunkBounds> m_chunkBounds;
+    glm::vec2 m_viewMin;
+    glm::vec2 m_viewMax;
+
+    //one (first frame, frame count) entry per array layer, followed by (array layer, end time) for each frame
+    std::vector<glm::uvec2> m_animationData;
+    std::unique_ptr<SEngine::Buffer> m_animationBuffer;
+    bool m_animated;
+
+    std::vector<uint32_t> m_tileIDs;
+    vk::Extent3D m_tileImageExtent;
+    std::unique_ptr<SEngine::Image> m_tileImage;
+    std::unique_ptr<vk::raii::ImageView> m_tileImageView;
 
     std::unique_ptr<vk::raii::RenderPass> m_renderPass;
-    std::vector<vk::raii::Framebuffer> m_framebuffers;
+    vk::Format m_attachmentFormat;
+    std::vector<std::unique_ptr<vk::raii::Framebuffer>> m_framebuffers;
     std::unique_ptr<vk::raii::DescriptorSetLayout> m_descriptorLayout;
     std::unique_ptr<vk::raii::DescriptorPool> m_descriptorPool;
-    std::unique_ptr<vk::DescriptorSet> m_descriptor;
+    std::vector<vk::DescriptorSet> m_descriptors;  //per frame in flight
+    std::vector<bool> m_descriptorDirty;
     std::unique_ptr<vk::raii::PipelineLayout> m_pipelineLayout;
-    std::unique_ptr<vk::raii::Pipeline> m_pipeline;
-
-    std::unique_ptr<SEngine::Buffer> m_vertexBuffer;
+    std::unique_ptr<SEngine::PipelineVariants> m_pipelines;
+    std::unique_ptr<SEngine::PipelineVariants> m_tileTexturePipelines;
+
+    std::unique_ptr<vk::raii::DescriptorSetLayout> m_cullDescriptorLayout;
+    std::unique_ptr<vk::raii::DescriptorPool> m_cullDescriptorPool;
+    std::vector<vk::DescriptorSet> m_cullDescriptors;
+    std::vector<bool> m_cullDescriptorDirty;
+    std::unique_ptr<vk::raii::PipelineLayout> m_cullPipelineLayout;
+    std::unique_ptr<vk::raii::Pipeline> m_cullPipeline;
+
+    std::unique_ptr<SEngine::Buffer> m_instanceBuffer;
+    std::unique_ptr<SEngine::Buffer> m_indexBuffer;
     std::unique_ptr<SEngine::Buffer> m_uniformBuffer;
+    std::unique_ptr<SEngine::Buffer> m_chunkBuffer;
+    std::unique_ptr<SEngine::Buffer> m_drawBuffer;  //per frame in flight: draw count followed by one draw command per chunk
+    vk::DeviceSize m_drawStride;
     std::unique_ptr<vk::raii::Sampler> m_sampler;
 
     std::unique_ptr<SEngine::RenderGraph::BufferUsage> m_bufferUsage;
+    std::unique_ptr<SEngine::RenderGraph::BufferUsage> m_computeUsage;
     std::unique_ptr<SEngine::RenderGraph::ImageUsage> m_imageUsage;
 
-    entt::scoped_connection m_swapchainConnection;
+    entt::scoped_connection m_targetConnection;
+    entt::scoped_connection m_uniformRelocatedConnection;
+    entt::scoped_connection m_instanceRelocatedConnection;
+    entt::scoped_connection m_animationRelocatedConnection;
+    entt::scoped_connection m_chunkRelocatedConnection;
+    entt::scoped_connection m_drawRelocatedConnection;
 
     struct UniformData {
         glm::mat4 projectionMatrix;
         glm::mat4 viewMatrix;
+        uint32_t time;  //milliseconds, drives tile animations
     };
 
     UniformData m_uniform;
 
     void createRenderPass();
-    void createFramebuffers();
+    vk::raii::Framebuffer& getFramebuffer(uint32_t imageIndex);
+    void beginRendering(vk::raii::CommandBuffer& commandBuffer, uint32_t imageIndex);
+    void endRendering(vk::raii::CommandBuffer& commandBuffer, uint32_t imageIndex);
 
     void recreateResources(vk::raii::SwapchainKHR* swapchain);
+    void onBufferRelocated(SEngine::Buffer& buffer);
 
     void createUniformBuffer();
+    void createIndexBuffer();
     void createSampler();
     void createDescriptorLayout();
     void createDescriptorPool();
-    void createDescriptor();
-    void updateDescriptor();
+    void createDescriptors();
+    void updateDescriptor(uint32_t frame);
+    void invalidateDescriptors();
+    void createCullDescriptors();
+    void updateCullDescriptor(uint32_t frame);
+    void createCullPipeline();
+
+    void updateViewBounds();
+    bool isVisible(const Chunk& chunk) const;
 
     vk::raii::ShaderModule createShader(const std::string& filename);
-    void createPipeline();
-    void createVertexData();
-    void createVertexBuffer();
+    void createPipelineLayout();
+    void createPipelines();
+    vk::raii::Pipeline& getPipeline(SEngine::PipelineVariants& variants);
+    std::unique_ptr<vk::raii::Pipeline> createInstancePipeline(const vk::SpecializationInfo& specialization);
+    std::unique_ptr<vk::raii::Pipeline> createTileTexturePipeline(const vk::SpecializationInfo& specialization);
+    std::unique_ptr<vk::raii::Pipeline> createPipeline(const std::string& vertexShaderName, const std::string& fragmentShaderName, const vk::PipelineVertexInputStateCreateInfo& vertexInput, const vk::SpecializationInfo& specialization);
+    uint32_t mapFeatures() const;
+    void clearMap();
+    void createInstanceData();
+    void createInstanceBuffer();
+    void createChunkBuffers();
+    void createSpritesheet();
+    void createAnimationData();
+    void createTileImage();
+    void buildChunk(Chunk& chunk);
+    void checkTile(size_t layer, int32_t x, int32_t y, uint32_t gid) const;
+    void markDirty(size_t layer, int32_t x, int32_t y);
+    void uploadChanges();
+
+    void cullChunks(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
+    void renderInstances(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
+    void renderTileImage(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
 };
\ No newline at end of file
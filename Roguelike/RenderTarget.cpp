@@ -0,0 +1,119 @@
+#include "RenderTarget.h"
+#include <algorithm>
+
+RenderTarget::RenderTarget(SEngine::Engine& engine, SEngine::AcquireNode& acquireNode)
+    : m_onChanged(m_onChangedSignal) {
+    m_engine = &engine;
+    m_graphics = &engine.getGraphics();
+    m_acquireNode = &acquireNode;
+    m_scale = 1;
+    m_extent = m_graphics->swapchainExtent();
+
+    m_swapchainConnection = m_graphics->onSwapchainChanged().connect<&RenderTarget::onSwapchainChanged>(this);
+}
+
+RenderTarget::RenderTarget(SEngine::Engine& engine, uint32_t scale)
+    : m_onChanged(m_onChangedSignal) {
+    if (scale == 0) throw std::runtime_error("Render target scale must be at least 1");
+
+    m_engine = &engine;
+    m_graphics = &engine.getGraphics();
+    m_acquireNode = nullptr;
+    m_scale = scale;
+
+    createImages();
+
+    m_swapchainConnection = m_graphics->onSwapchainChanged().connect<&RenderTarget::onSwapchainChanged>(this);
+}
+
+vk::Format RenderTarget::format() const {
+    //the offscreen images share the swapchain format, so pipelines work with either target
+    return m_graphics->swapchainFormat();
+}
+
+vk::Extent2D RenderTarget::extent() const {
+    return m_extent;
+}
+
+size_t RenderTarget::imageCount() const {
+    if (!offscreen()) return m_graphics->swapchainImages().size();
+    return m_images.size();
+}
+
+uint32_t RenderTarget::imageIndex() const {
+    if (!offscreen()) return m_acquireNode->swapchainIndex();
+    return m_engine->getRenderGraph().currentFrame();
+}
+
+vk::Image RenderTarget::image(uint32_t index) const {
+    if (!offscreen()) return m_graphics->swapchainImages()[index];
+    return m_images[index]->image();
+}
+
+const vk::raii::ImageView& RenderTarget::imageView(uint32_t index) const {
+    if (!offscreen()) return m_graphics->swapchainImageViews()[index];
+    return *m_imageViews[index];
+}
+
+void RenderTarget::releaseImages() {
+    auto& graph = m_engine->getRenderGraph();
+
+    for (auto& imageView : m_imageViews) {
+        graph.queueDestroy(std::move(imageView));
+    }
+
+    //images defer their own destruction
+    m_imageViews.clear();
+    m_images.clear();
+}
+
+void RenderTarget::onSwapchainChanged(vk::raii::SwapchainKHR* swapchain) {
+    if (offscreen()) {
+        releaseImages();
+
+        if (swapchain != nullptr) {
+            createImages();
+        }
+    } else {
+        m_extent = m_graphics->swapchainExtent();
+    }
+
+    m_onChangedSignal.publish(swapchain);
+}
+
+void RenderTarget::createImages() {
+    //rounded down, UpscaleNode letterboxes the few pixels left over
+    vk::Extent2D swapchainExtent = m_graphics->swapchainExtent();
+    m_extent.width = std::max<uint32_t>(1, swapchainExtent.width / m_scale);
+    m_extent.height = std::max<uint32_t>(1, swapchainExtent.height / m_scale);
+
+    vk::ImageCreateInfo info = {};
+    info.usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc;
+    info.imageType = vk::ImageType::e2D;
+    info.format = format();
+    info.extent = vk::Extent3D{ m_extent.width, m_extent.height, 1 };
+    info.arrayLayers = 1;
+    info.mipLevels = 1;
+    info.samples = vk::SampleCountFlagBits::e1;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    uint32_t framesInFlight = m_engine->getRenderGraph().framesInFlight();
+
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        auto& image = m_images.emplace_back(std::make_unique<SEngine::Image>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Texture, "Render target"));
+
+        vk::ImageViewCreateInfo viewInfo = {};
+        viewInfo.image = image->image();
+        viewInfo.format = info.format;
+        viewInfo.viewType = vk::ImageViewType::e2D;
+        viewInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+
+        m_imageViews.emplace_back(std::make_unique<vk::raii::ImageView>(m_graphics->device(), viewInfo));
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SimpleEngine/SimpleEngine.h>
+#include <SimpleEngine/RenderGraph/RenderGraph.h>
+#include <SimpleEngine/RenderGraph/AcquireNode.h>
+#include <entt/signal/sigh.hpp>
+
+//the color image the world is drawn into. either the acquired swapchain image, or an offscreen image
+//at native pixel art resolution which UpscaleNode then scales into the swapchain
+class RenderTarget {
+public:
+    RenderTarget(SEngine::Engine& engine, SEngine::AcquireNode& acquireNode);
+    RenderTarget(SEngine::Engine& engine, uint32_t scale);
+    RenderTarget(const RenderTarget& other) = delete;
+    RenderTarget& operator = (const RenderTarget& other) = delete;
+    RenderTarget(RenderTarget&& other) = delete;
+    RenderTarget& operator = (RenderTarget&& other) = delete;
+
+    bool offscreen() const { return m_acquireNode == nullptr; }
+    uint32_t scale() const { return m_scale; }
+
+    vk::Format format() const;
+    vk::Extent2D extent() const;
+
+    //swapchain images, or one offscreen image per frame in flight
+    size_t imageCount() const;
+    uint32_t imageIndex() const;
+    vk::Image image(uint32_t index) const;
+    const vk::raii::ImageView& imageView(uint32_t index) const;
+
+    //hands the offscreen images to the render graph's destroy queues, so this must be called before the graph is destroyed
+    void releaseImages();
+
+    //fired after the swapchain changes, once the offscreen images have been recreated
+    entt::sink<void(vk::raii::SwapchainKHR*)>& onChanged() { return m_onChanged; }
+
+private:
+    SEngine::Engine* m_engine;
+    SEngine::Graphics* m_graphics;
+    SEngine::AcquireNode* m_acquireNode;
+    uint32_t m_scale;
+    vk::Extent2D m_extent;
+
+    std::vector<std::unique_ptr<SEngine::Image>> m_images;
+    std::vector<std::unique_ptr<vk::raii::ImageView>> m_imageViews;
+
+    entt::scoped_connection m_swapchainConnection;
+    entt::sigh<void(vk::raii::SwapchainKHR*)> m_onChangedSignal;
+    entt::sink<void(vk::raii::SwapchainKHR*)> m_onChanged;
+
+    void onSwapchainChanged(vk::raii::SwapchainKHR* swapchain);
+    void createImages();
+};
@@ -0,0 +1,480 @@
+#include "SpriteNode.h"
+#include <SimpleEngine/SimpleEngine.h>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+
+SpriteNode::SpriteNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, RenderTarget& target, SEngine::TransferNode& transferNode)
+    : SEngine::RenderGraph::Node(graph, engine.getGraphics().graphicsQueue()) {
+    m_engine = &engine;
+    m_graphics = &engine.getGraphics();
+    m_target = &target;
+    m_transferNode = &transferNode;
+    m_camera = nullptr;
+    m_spritesheetView = nullptr;
+    m_instanceCount = 0;
+    m_uniform = {};
+
+    m_bufferUsage = std::make_unique<SEngine::RenderGraph::BufferUsage>(*this, vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput);
+    m_uniformUsage = std::make_unique<SEngine::RenderGraph::BufferUsage>(*this, vk::AccessFlagBits::eUniformRead, vk::PipelineStageFlagBits::eVertexShader);
+
+    m_imageUsage = std::make_unique<SEngine::RenderGraph::ImageUsage>(
+        *this, vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits::eColorAttachmentWrite, vk::PipelineStageFlagBits::eColorAttachmentOutput
+    );
+
+    m_instanceBuffers.resize(graph.framesInFlight());
+
+    createRenderPass();
+    m_framebuffers.resize(m_target->imageCount());
+    createUniformBuffer();
+    createSampler();
+    createDescriptorLayout();
+    createDescriptorPool();
+    createDescriptors();
+    createPipeline();
+
+    m_targetConnection = target.onChanged().connect<&SpriteNode::recreateResources>(this);
+}
+
+void SpriteNode::setCamera(SEngine::Camera& camera) {
+    m_camera = &camera;
+}
+
+void SpriteNode::setSpritesheet(vk::raii::ImageView& spritesheetView) {
+    m_spritesheetView = &spritesheetView;
+    invalidateDescriptors();
+}
+
+void SpriteNode::draw(const Sprite& sprite) {
+    m_sprites.push_back(sprite);
+}
+
+void SpriteNode::preRender(uint32_t currentFrame) {
+    if (m_camera != nullptr) {
+        m_uniform.projectionMatrix = m_camera->projectionMatrix();
+        m_uniform.viewMatrix = m_camera->viewMatrix();
+    }
+
+    m_transferNode->transfer(*m_uniformBuffer, sizeof(UniformData), 0, &m_uniform);
+    m_uniformUsage->sync(*m_uniformBuffer, sizeof(UniformData), 0);
+
+    updateInstanceBuffer(currentFrame);
+}
+
+void SpriteNode::updateInstanceBuffer(uint32_t currentFrame) {
+    //back to front, so alpha blending composites correctly in a single draw.
+    //every tileset shares the map's array texture, so depth is the only batch key
+    std::stable_sort(m_sprites.begin(), m_sprites.end(), [](const Sprite& a, const Sprite& b) {
+        return a.depth < b.depth;
+    });
+
+    m_instanceData.resize(m_sprites.size());
+
+    for (size_t i = 0; i < m_sprites.size(); i++) {
+        auto& sprite = m_sprites[i];
+        auto& instance = m_instanceData[i];
+
+        instance.position = glm::vec3(sprite.position, sprite.depth);
+        instance.gid = sprite.gid;
+        instance.tint = glm::packUnorm4x8(sprite.tint);
+    }
+
+    m_instanceCount = static_cast<uint32_t>(m_instanceData.size());
+    m_sprites.clear();
+
+    if (m_instanceCount == 0) return;
+
+    auto& buffer = m_instanceBuffers[currentFrame];
+    vk::DeviceSize size = m_instanceData.size() * sizeof(SpriteInstance);
+
+    if (buffer == nullptr || buffer->size() < size) {
+        //grow geometrically so a rising entity count does not reallocate every frame
+        vk::DeviceSize capacity = std::max<vk::DeviceSize>(size, buffer != nullptr ? buffer->size() * 2 : 0);
+
+        vk::BufferCreateInfo info = {};
+        info.size = capacity;
+        info.usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        buffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Vertex, "Sprites");
+    }
+
+    m_transferNode->transfer(*buffer, size, 0, m_instanceData.data());
+    m_bufferUsage->sync(*buffer, size, 0);
+}
+
+void SpriteNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
+    //buffers are only relocated before render, and the graph has waited on the last frame that used this frame's set
+    if (m_descriptorDirty[currentFrame] && m_spritesheetView != nullptr) {
+        updateDescriptor(currentFrame);
+        m_descriptorDirty[currentFrame] = false;
+    }
+
+    uint32_t imageIndex = m_target->imageIndex();
+    vk::ClearValue clear = {};
+
+    //the render pass is always begun, even without sprites, since it moves the image into its final layout
+    vk::RenderPassBeginInfo renderPassInfo = {};
+    renderPassInfo.renderPass = **m_renderPass;
+    renderPassInfo.framebuffer = *getFramebuffer(imageIndex);
+    renderPassInfo.renderArea = vk::Rect2D{ {}, m_target->extent() };
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clear;
+
+    commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+
+    if (m_instanceCount > 0 && m_spritesheetView != nullptr) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **m_pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, **m_pipelineLayout, 0, m_descriptors[currentFrame], nullptr);
+        commandBuffer.bindVertexBuffers(0, m_instanceBuffers[currentFrame]->buffer(), { 0 });
+
+        vk::Extent2D extent = m_target->extent();
+
+        vk::Viewport viewport = {};
+        viewport.minDepth = 0;
+        viewport.maxDepth = 1;
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
+
+        vk::Rect2D scissor = {};
+        scissor.extent = extent;
+
+        commandBuffer.setViewport(0, viewport);
+        commandBuffer.setScissor(0, scissor);
+
+        commandBuffer.draw(6, m_instanceCount, 0, 0);
+    }
+
+    commandBuffer.endRenderPass();
+}
+
+void SpriteNode::onBake() {
+    for (auto& framebuffer : m_framebuffers) {
+        graph().queueDestroy(std::move(framebuffer));
+    }
+
+    graph().queueDestroy(std::move(m_renderPass));
+    createRenderPass();
+}
+
+void SpriteNode::recreateResources(vk::raii::SwapchainKHR* swapchain) {
+    for (auto& framebuffer : m_framebuffers) {
+        graph().queueDestroy(std::move(framebuffer));
+    }
+
+    m_framebuffers.clear();
+
+    if (swapchain == nullptr) return;
+
+    if (m_target->format() != m_renderPassFormat) {
+        graph().queueDestroy(std::move(m_renderPass));
+        graph().queueDestroy(std::move(m_pipeline));
+        createRenderPass();
+        createPipeline();
+    }
+
+    m_framebuffers.resize(m_target->imageCount());
+}
+
+void SpriteNode::onBufferRelocated(SEngine::Buffer& buffer) {
+    invalidateDescriptors();
+}
+
+void SpriteNode::invalidateDescriptors() {
+    //frames in flight may still have the old sets bound, so each set is rewritten when its frame is next recorded
+    std::fill(m_descriptorDirty.begin(), m_descriptorDirty.end(), true);
+}
+
+void SpriteNode::createRenderPass() {
+    auto& attachmentInfo = m_imageUsage->attachmentInfo();
+
+    vk::AttachmentDescription colorAttachment = {};
+    colorAttachment.format = m_target->format();
+    colorAttachment.samples = vk::SampleCountFlagBits::e1;
+    colorAttachment.loadOp = attachmentInfo.loadOp;
+    colorAttachment.storeOp = attachmentInfo.storeOp;
+    colorAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
+    colorAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+    colorAttachment.initialLayout = attachmentInfo.initialLayout;
+    colorAttachment.finalLayout = attachmentInfo.finalLayout;
+
+    vk::AttachmentReference colorAttachmentRef = {};
+    colorAttachmentRef.attachment = 0;
+    colorAttachmentRef.layout = vk::ImageLayout::eColorAttachmentOptimal;
+
+    vk::SubpassDescription subpass = {};
+    subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentRef;
+
+    vk::RenderPassCreateInfo info = {};
+    info.attachmentCount = 1;
+    info.pAttachments = &colorAttachment;
+    info.subpassCount = 1;
+    info.pSubpasses = &subpass;
+
+    m_renderPass = std::make_unique<vk::raii::RenderPass>(m_graphics->device(), info);
+    m_renderPassFormat = colorAttachment.format;
+}
+
+vk::raii::Framebuffer& SpriteNode::getFramebuffer(uint32_t imageIndex) {
+    auto& framebuffer = m_framebuffers[imageIndex];
+
+    if (framebuffer == nullptr) {
+        vk::Extent2D extent = m_target->extent();
+
+        vk::FramebufferCreateInfo info = {};
+        info.renderPass = **m_renderPass;
+        info.width = extent.width;
+        info.height = extent.height;
+        info.layers = 1;
+        info.attachmentCount = 1;
+        info.pAttachments = &*m_target->imageView(imageIndex);
+
+        framebuffer = std::make_unique<vk::raii::Framebuffer>(m_graphics->device(), info);
+    }
+
+    return *framebuffer;
+}
+
+void SpriteNode::createUniformBuffer() {
+    vk::BufferCreateInfo info = {};
+    info.size = sizeof(UniformData);
+    info.usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_uniformBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Uniform, "Sprite camera uniform");
+    m_uniformRelocatedConnection = m_uniformBuffer->onRelocated().connect<&SpriteNode::onBufferRelocated>(this);
+}
+
+void SpriteNode::createSampler() {
+    vk::SamplerCreateInfo info = {};
+    info.addressModeU = vk::SamplerAddressMode::eRepeat;
+    info.addressModeV = vk::SamplerAddressMode::eRepeat;
+    info.magFilter = vk::Filter::eNearest;
+    info.minFilter = vk::Filter::eNearest;
+
+    m_sampler = std::make_unique<vk::raii::Sampler>(m_graphics->device(), info);
+}
+
+void SpriteNode::createDescriptorLayout() {
+    vk::DescriptorSetLayoutBinding binding0 = {};
+    binding0.descriptorType = vk::DescriptorType::eUniformBuffer;
+    binding0.descriptorCount = 1;
+    binding0.stageFlags = vk::ShaderStageFlagBits::eVertex;
+    binding0.binding = 0;
+
+    vk::DescriptorSetLayoutBinding binding1 = {};
+    binding1.descriptorType = vk::DescriptorType::eSampler;
+    binding1.descriptorCount = 1;
+    binding1.stageFlags = vk::ShaderStageFlagBits::eFragment;
+    binding1.binding = 1;
+
+    vk::DescriptorSetLayoutBinding binding2 = {};
+    binding2.descriptorType = vk::DescriptorType::eSampledImage;
+    binding2.descriptorCount = 1;
+    binding2.stageFlags = vk::ShaderStageFlagBits::eFragment;
+    binding2.binding = 2;
+
+    vk::DescriptorSetLayoutBinding bindings[] = { binding0, binding1, binding2 };
+
+    vk::DescriptorSetLayoutCreateInfo info = {};
+    info.bindingCount = 3;
+    info.pBindings = bindings;
+
+    m_descriptorLayout = std::make_unique<vk::raii::DescriptorSetLayout>(m_graphics->device(), info);
+}
+
+void SpriteNode::createDescriptorPool() {
+    //one set per frame in flight, so a set is never rewritten while a frame still uses it
+    uint32_t framesInFlight = graph().framesInFlight();
+
+    vk::DescriptorPoolSize poolSize0 = {};
+    poolSize0.descriptorCount = framesInFlight;
+    poolSize0.type = vk::DescriptorType::eUniformBuffer;
+
+    vk::DescriptorPoolSize poolSize1 = {};
+    poolSize1.descriptorCount = framesInFlight;
+    poolSize1.type = vk::DescriptorType::eSampler;
+
+    vk::DescriptorPoolSize poolSize2 = {};
+    poolSize2.descriptorCount = framesInFlight;
+    poolSize2.type = vk::DescriptorType::eSampledImage;
+
+    vk::DescriptorPoolSize poolSizes[] = { poolSize0, poolSize1, poolSize2 };
+
+    vk::DescriptorPoolCreateInfo info = {};
+    info.maxSets = framesInFlight;
+    info.poolSizeCount = 3;
+    info.pPoolSizes = poolSizes;
+
+    m_descriptorPool = std::make_unique<vk::raii::DescriptorPool>(m_graphics->device(), info);
+}
+
+void SpriteNode::createDescriptors() {
+    uint32_t framesInFlight = graph().framesInFlight();
+    std::vector<vk::DescriptorSetLayout> layouts(framesInFlight, **m_descriptorLayout);
+
+    vk::DescriptorSetAllocateInfo info = {};
+    info.descriptorPool = **m_descriptorPool;
+    info.descriptorSetCount = framesInFlight;
+    info.pSetLayouts = layouts.data();
+
+    m_descriptors = (*m_graphics->device()).allocateDescriptorSets(info);
+    m_descriptorDirty.assign(framesInFlight, true);
+}
+
+void SpriteNode::updateDescriptor(uint32_t frame) {
+    vk::DescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = m_uniformBuffer->buffer();
+    bufferInfo.range = m_uniformBuffer->size();
+
+    vk::WriteDescriptorSet write0 = {};
+    write0.descriptorCount = 1;
+    write0.descriptorType = vk::DescriptorType::eUniformBuffer;
+    write0.dstSet = m_descriptors[frame];
+    write0.dstBinding = 0;
+    write0.pBufferInfo = &bufferInfo;
+
+    vk::DescriptorImageInfo samplerInfo = {};
+    samplerInfo.sampler = **m_sampler;
+
+    vk::WriteDescriptorSet write1 = {};
+    write1.descriptorCount = 1;
+    write1.descriptorType = vk::DescriptorType::eSampler;
+    write1.dstSet = m_descriptors[frame];
+    write1.dstBinding = 1;
+    write1.pImageInfo = &samplerInfo;
+
+    vk::DescriptorImageInfo imageInfo = {};
+    imageInfo.imageView = **m_spritesheetView;
+    imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    vk::WriteDescriptorSet write2 = {};
+    write2.descriptorCount = 1;
+    write2.descriptorType = vk::DescriptorType::eSampledImage;
+    write2.dstSet = m_descriptors[frame];
+    write2.dstBinding = 2;
+    write2.pImageInfo = &imageInfo;
+
+    m_graphics->device().updateDescriptorSets({ write0, write1, write2 }, nullptr);
+}
+
+vk::raii::ShaderModule SpriteNode::createShader(const std::string& filename) {
+    auto data = SEngine::readFile(filename);
+
+    vk::ShaderModuleCreateInfo info = {};
+    info.codeSize = data.size();
+    info.pCode = reinterpret_cast<const uint32_t*>(data.data());
+
+    return vk::raii::ShaderModule(m_graphics->device(), info);
+}
+
+void SpriteNode::createPipeline() {
+    auto vertexShader = createShader("shaders/sprite.vert.spv");
+    auto fragmentShader = createShader("shaders/sprite.frag.spv");
+
+    vk::PipelineShaderStageCreateInfo vertexStage = {};
+    vertexStage.stage = vk::ShaderStageFlagBits::eVertex;
+    vertexStage.module = *vertexShader;
+    vertexStage.pName = "main";
+
+    vk::PipelineShaderStageCreateInfo fragmentStage = {};
+    fragmentStage.stage = vk::ShaderStageFlagBits::eFragment;
+    fragmentStage.module = *fragmentShader;
+    fragmentStage.pName = "main";
+
+    std::array<vk::PipelineShaderStageCreateInfo, 2> stages = { vertexStage, fragmentStage };
+
+    vk::VertexInputBindingDescription bindingDescription = {};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(SpriteInstance);
+    bindingDescription.inputRate = vk::VertexInputRate::eInstance;
+
+    std::array<vk::VertexInputAttributeDescription, 3> attributeDescriptions = {};
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = vk::Format::eR32G32B32Sfloat;
+    attributeDescriptions[0].offset = offsetof(SpriteInstance, position);
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = vk::Format::eR32Uint;
+    attributeDescriptions[1].offset = offsetof(SpriteInstance, gid);
+    attributeDescriptions[2].binding = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = vk::Format::eR8G8B8A8Unorm;
+    attributeDescriptions[2].offset = offsetof(SpriteInstance, tint);
+
+    vk::PipelineVertexInputStateCreateInfo vertexInput = {};
+    vertexInput.vertexBindingDescriptionCount = 1;
+    vertexInput.pVertexBindingDescriptions = &bindingDescription;
+    vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInput.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.topology = vk::PrimitiveTopology::eTriangleList;
+
+    vk::PipelineViewportStateCreateInfo viewportState = {};
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    vk::PipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.polygonMode = vk::PolygonMode::eFill;
+    rasterizer.cullMode = vk::CullModeFlagBits::eBack;
+    rasterizer.frontFace = vk::FrontFace::eClockwise;
+    rasterizer.lineWidth = 1.0f;
+
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask =
+        vk::ColorComponentFlagBits::eR
+        | vk::ColorComponentFlagBits::eG
+        | vk::ColorComponentFlagBits::eB
+        | vk::ColorComponentFlagBits::eA;
+    colorBlendAttachment.blendEnable = true;
+    colorBlendAttachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+    colorBlendAttachment.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+    colorBlendAttachment.colorBlendOp = vk::BlendOp::eAdd;
+    colorBlendAttachment.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+    colorBlendAttachment.dstAlphaBlendFactor = vk::BlendFactor::eZero;
+    colorBlendAttachment.alphaBlendOp = vk::BlendOp::eAdd;
+
+    vk::PipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    vk::DynamicState dynamicStates[] = {
+        vk::DynamicState::eScissor,
+        vk::DynamicState::eViewport
+    };
+
+    vk::PipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    vk::PipelineMultisampleStateCreateInfo multisample = {};
+    multisample.rasterizationSamples = vk::SampleCountFlagBits::e1;
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &**m_descriptorLayout;
+
+    m_pipelineLayout = std::make_unique<vk::raii::PipelineLayout>(m_graphics->device(), pipelineLayoutInfo);
+
+    vk::GraphicsPipelineCreateInfo info = {};
+    info.stageCount = 2;
+    info.pStages = stages.data();
+    info.pVertexInputState = &vertexInput;
+    info.pInputAssemblyState = &inputAssembly;
+    info.pViewportState = &viewportState;
+    info.pRasterizationState = &rasterizer;
+    info.pColorBlendState = &colorBlending;
+    info.pDynamicState = &dynamicState;
+    info.pMultisampleState = &multisample;
+    info.layout = **m_pipelineLayout;
+    info.renderPass = **m_renderPass;
+
+    m_pipeline = std::make_unique<vk::raii::Pipeline>(m_graphics->device(), m_graphics->pipelineCache(), info);
+}
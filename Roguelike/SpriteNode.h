@@ -0,0 +1,105 @@
+#pragma once
+
+#include <SimpleEngine/SimpleEngine.h>
+#include <SimpleEngine/RenderGraph/RenderGraph.h>
+#include <SimpleEngine/RenderGraph/TransferNode.h>
+#include <entt/signal/sigh.hpp>
+#include <glm/glm.hpp>
+
+#include "RenderTarget.h"
+
+//draws sprites for dynamic entities on top of the map, using the map's tileset texture.
+//RenderNode packs every tileset into that one array texture, so all sprites go out in a single instanced draw
+class SpriteNode : public SEngine::RenderGraph::Node {
+public:
+    struct Sprite {
+        glm::vec2 position;
+        float depth;
+        uint32_t gid;       //Tiled GID, flip bits included
+        glm::vec4 tint;
+    };
+
+    SpriteNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, RenderTarget& target, SEngine::TransferNode& transferNode);
+
+    void setCamera(SEngine::Camera& camera);
+    void setSpritesheet(vk::raii::ImageView& spritesheetView);
+
+    //sprites only last one frame, so entities submit themselves every frame
+    void draw(const Sprite& sprite);
+
+    SEngine::RenderGraph::BufferUsage& bufferUsage() { return *m_bufferUsage; }
+    SEngine::RenderGraph::BufferUsage& uniformUsage() { return *m_uniformUsage; }
+    SEngine::RenderGraph::ImageUsage& imageUsage() { return *m_imageUsage; }
+
+    void preRender(uint32_t currentFrame);
+    void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
+    void postRender(uint32_t currentFrame) {}
+    void onBake();
+
+    //sprites are dynamic, so any submitted sprite redraws. one more frame clears the last ones
+    bool isDirty() const { return m_sprites.size() > 0 || m_instanceCount > 0; }
+
+private:
+    struct SpriteInstance {
+        glm::vec3 position;
+        uint32_t gid;
+        uint32_t tint;
+    };
+
+    struct UniformData {
+        glm::mat4 projectionMatrix;
+        glm::mat4 viewMatrix;
+    };
+
+    SEngine::Engine* m_engine;
+    SEngine::Graphics* m_graphics;
+    RenderTarget* m_target;
+    SEngine::TransferNode* m_transferNode;
+    SEngine::Camera* m_camera;
+    vk::raii::ImageView* m_spritesheetView;
+
+    std::vector<Sprite> m_sprites;
+    std::vector<SpriteInstance> m_instanceData;
+    std::vector<std::unique_ptr<SEngine::Buffer>> m_instanceBuffers;
+    uint32_t m_instanceCount;
+
+    vk::Format m_renderPassFormat;
+    std::unique_ptr<vk::raii::RenderPass> m_renderPass;
+    std::vector<std::unique_ptr<vk::raii::Framebuffer>> m_framebuffers;
+    std::unique_ptr<vk::raii::DescriptorSetLayout> m_descriptorLayout;
+    std::unique_ptr<vk::raii::DescriptorPool> m_descriptorPool;
+    std::vector<vk::DescriptorSet> m_descriptors;  //per frame in flight
+    std::vector<bool> m_descriptorDirty;
+    std::unique_ptr<vk::raii::PipelineLayout> m_pipelineLayout;
+    std::unique_ptr<vk::raii::Pipeline> m_pipeline;
+
+    std::unique_ptr<SEngine::Buffer> m_uniformBuffer;
+    std::unique_ptr<vk::raii::Sampler> m_sampler;
+
+    std::unique_ptr<SEngine::RenderGraph::BufferUsage> m_bufferUsage;
+    std::unique_ptr<SEngine::RenderGraph::BufferUsage> m_uniformUsage;
+    std::unique_ptr<SEngine::RenderGraph::ImageUsage> m_imageUsage;
+
+    entt::scoped_connection m_targetConnection;
+    entt::scoped_connection m_uniformRelocatedConnection;
+
+    UniformData m_uniform;
+
+    void createRenderPass();
+    vk::raii::Framebuffer& getFramebuffer(uint32_t imageIndex);
+
+    void recreateResources(vk::raii::SwapchainKHR* swapchain);
+    void onBufferRelocated(SEngine::Buffer& buffer);
+
+    void createUniformBuffer();
+    void createSampler();
+    void createDescriptorLayout();
+    void createDescriptorPool();
+    void createDescriptors();
+    void updateDescriptor(uint32_t frame);
+    void invalidateDescriptors();
+
+    vk::raii::ShaderModule createShader(const std::string& filename);
+    void createPipeline();
+    void updateInstanceBuffer(uint32_t currentFrame);
+};
@@ -1,27 +1,171 @@
 #include "TiledReader.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <libbase64.h>
 #include <zlib.h>
 
+#include <SimpleEngine/ThreadPool.h>
+
 #include "../Decompress.h"
 
-Tiled::LayerData::LayerData(uint32_t dataRaw) {
-    id = dataRaw & 0x1FFFFFFF;
-    flipX = (dataRaw & 0x80000000) != 0;
-    flipY = (dataRaw & 0x40000000) != 0;
-    flipDiagonal = (dataRaw & 0x20000000) != 0;
+#define BASE64_BLOCK (1024 * 64)
+
+namespace {
+    //builds the json DOM through nlohmann's public SAX interface. the "data" strings of layer objects are moved into
+    //a side table and replaced by their index, so multi-megabyte layer data is never copied into or back out of the DOM
+    class TiledSaxParser : public nlohmann::json_sax<nlohmann::json> {
+    public:
+        TiledSaxParser(nlohmann::json& root, std::vector<std::string>& strings) {
+            m_root = &root;
+            m_strings = &strings;
+            m_member = nullptr;
+            m_dataKey = false;
+            m_layersKey = false;
+        }
+
+        bool null() override {
+            addValue(nullptr);
+            return true;
+        }
+
+        bool boolean(bool val) override {
+            addValue(val);
+            return true;
+        }
+
+        bool number_integer(number_integer_t val) override {
+            addValue(val);
+            return true;
+        }
+
+        bool number_unsigned(number_unsigned_t val) override {
+            addValue(val);
+            return true;
+        }
+
+        bool number_float(number_float_t val, const string_t& s) override {
+            addValue(val);
+            return true;
+        }
+
+        bool string(string_t& val) override {
+            if (m_dataKey) {
+                m_strings->push_back(std::move(val));
+                addValue(m_strings->size() - 1);
+            } else {
+                addValue(std::move(val));
+            }
+
+            return true;
+        }
+
+        bool binary(binary_t& val) override {
+            addValue(nlohmann::json::binary(std::move(val)));
+            return true;
+        }
+
+        bool start_object(std::size_t elements) override {
+            //objects directly inside a "layers" array are layers
+            bool layer = m_scopes.size() > 0 && m_scopes.back().layers;
+            nlohmann::json* object = addValue(nlohmann::json::object());
+            m_scopes.push_back({ object, layer, false });
+            return true;
+        }
+
+        bool key(string_t& val) override {
+            auto& scope = m_scopes.back();
+            m_member = &(*scope.value)[val];
+
+            //"layers" holds layers in the map and in group layers, "data" only holds layer data in a layer
+            m_dataKey = scope.layer && val == "data";
+            m_layersKey = (m_scopes.size() == 1 || scope.layer) && val == "layers";
+            return true;
+        }
+
+        bool end_object() override {
+            m_scopes.pop_back();
+            clearKey();
+            return true;
+        }
+
+        bool start_array(std::size_t elements) override {
+            bool layers = m_layersKey;
+            nlohmann::json* array = addValue(nlohmann::json::array());
+            m_scopes.push_back({ array, false, layers });
+            return true;
+        }
+
+        bool end_array() override {
+            m_scopes.pop_back();
+            clearKey();
+            return true;
+        }
+
+        bool parse_error(std::size_t position, const std::string& last_token, const nlohmann::json::exception& ex) override {
+            throw std::runtime_error(std::string("Failed to parse JSON: ") + ex.what());
+        }
+
+    private:
+        struct Scope {
+            nlohmann::json* value;
+            bool layer;     //a layer object
+            bool layers;    //an array of layer objects
+        };
+
+        nlohmann::json* m_root;
+        std::vector<std::string>* m_strings;
+        std::vector<Scope> m_scopes;
+        nlohmann::json* m_member;   //the value slot of the last key in the innermost object
+        bool m_dataKey;
+        bool m_layersKey;
+
+        void clearKey() {
+            m_dataKey = false;
+            m_layersKey = false;
+        }
+
+        //pointers to open scopes stay valid, since a parent array only grows after its open child has ended
+        nlohmann::json* addValue(nlohmann::json&& value) {
+            clearKey();
+
+            if (m_scopes.size() == 0) {
+                *m_root = std::move(value);
+                return m_root;
+            }
+
+            auto& scope = m_scopes.back();
+
+            if (scope.value->is_array()) {
+                scope.value->push_back(std::move(value));
+                return &scope.value->back();
+            }
+
+            *m_member = std::move(value);
+            return m_member;
+        }
+    };
 }
 
-Tiled::Tiled(const std::string& root) {
+static_assert(sizeof(Tiled::LayerData) == sizeof(uint32_t), "LayerData must match the GID layout in layer data");
+
+Tiled::Tiled(const std::string& root, SEngine::ThreadPool* threadPool) {
     m_root = root + "/";
+    m_threadPool = threadPool;
 }
 
-Tiled::Tileset& Tiled::loadTileset(const std::string& path) {
+void Tiled::parseFile(const std::string& path, nlohmann::json& json) {
     std::ifstream file(m_root + path);
+    if (!file) throw std::runtime_error("Failed to open " + path);
+
+    TiledSaxParser parser(json, m_layerData);
+    nlohmann::json::sax_parse(file, &parser);
+}
+
+Tiled::Tileset& Tiled::loadTileset(const std::string& path) {
     nlohmann::json json;
-    file >> json;
+    parseFile(path, json);
 
     return loadTileset(path, json);
 }
@@ -62,11 +206,13 @@ Tiled::Tileset& Tiled::loadTileset(const std::string& name, nlohmann::json& json
 }
 
 Tiled::Map& Tiled::loadMap(const std::string& path) {
-    std::ifstream file(m_root + path);
     nlohmann::json json;
-    file >> json;
+    parseFile(path, json);
+
+    Map& map = loadMap(json);
+    m_layerData.clear();
 
-    return loadMap(json);
+    return map;
 }
 
 Tiled::Map& Tiled::loadMap(nlohmann::json& json) {
@@ -88,12 +234,13 @@ void Tiled::loadMapTilesets(std::vector<Tileset>& tilesets, nlohmann::json& json
 
         if (sourcePathJSON.is_null()) {
             Tileset tileset = loadTileset(item);
+            tileset.firstGID = item["firstgid"].get<int32_t>();
+
             tilesets.push_back(tileset);
         } else {
             std::string path = sourcePathJSON.get<std::string>();
-            std::ifstream file(m_root + path);
             nlohmann::json sourceJSON;
-            file >> sourceJSON;
+            parseFile(path, sourceJSON);
 
             Tileset tileset = loadTileset(path, sourceJSON);
             tileset.firstGID = item["firstgid"].get<int32_t>();
@@ -108,14 +255,33 @@ void Tiled::loadTiles(std::vector<Tile>& tiles, nlohmann::json& json) {
         Tile tile = {};
         tile.id = item["id"].get<int32_t>();
 
+        auto it = item.find("animation");
+
+        if (it != item.end() && !it->is_null()) {
+            loadAnimation(tile.animation, *it);
+        }
+
         tiles.push_back(tile);
     }
 }
 
+void Tiled::loadAnimation(std::vector<Frame>& frames, nlohmann::json& json) {
+    for (auto& item : json) {
+        Frame frame = {};
+        frame.tileID = item["tileid"].get<int32_t>();
+        frame.duration = item["duration"].get<int32_t>();
+
+        frames.push_back(frame);
+    }
+}
+
 void Tiled::loadMapLayers(std::vector<Layer>& layers, nlohmann::json& json) {
+    //the json structure is read first, then the layers, which are independent, are decoded into their own storage
+    std::vector<LayerDecode> decodes;
+
     for (auto& item : json) {
         Layer layer = {};
-        auto compressionJson = item["compression"];
+        auto& compressionJson = item["compression"];
         Compression compression = Compression::None;
 
         if (!compressionJson.is_null()) {
@@ -128,7 +294,7 @@ void Tiled::loadMapLayers(std::vector<Layer>& layers, nlohmann::json& json) {
             }
         }
 
-        auto encodingJson = item["encoding"];
+        auto& encodingJson = item["encoding"];
 
         if (encodingJson.is_null()) {
             throw std::runtime_error("Encoding not defined (must be base64)");
@@ -138,48 +304,93 @@ void Tiled::loadMapLayers(std::vector<Layer>& layers, nlohmann::json& json) {
             throw std::runtime_error("Unsupported encoding (must be base64)");
         }
 
-        auto dataJson = item["data"];
+        auto& dataJson = item["data"];
 
-        if (!dataJson.is_string()) {
-            throw std::runtime_error("Unsupported encoding (must be base64)");
+        if (!dataJson.is_number_unsigned() || dataJson.get<size_t>() >= m_layerData.size()) {
+            throw std::runtime_error("Layer data missing or not a base64 string");
         }
 
-        std::string dataString = dataJson.get<std::string>();
-        std::vector<char> dataBytes;
-        dataBytes.resize(dataString.size());
-        size_t dataSize = dataBytes.size();
+        layer.width = item["width"].get<int32_t>();
+        layer.height = item["height"].get<int32_t>();
+        layer.id = item["id"].get<int32_t>();
 
-        base64_decode(dataString.data(), dataString.size(), dataBytes.data(), &dataSize, 0);
-        dataBytes.resize(dataSize);
+        if (layer.width < 0 || layer.height < 0) {
+            throw std::runtime_error("Invalid layer size");
+        }
 
-        std::vector<uint32_t> dataRaw;
+        layer.data.resize((size_t)layer.width * layer.height);
 
-        if (compression == Compression::Zlib) {
-            dataRaw = std::move(decompress(dataBytes));
-        } else {
-            dataRaw.resize(dataSize / sizeof(uint32_t));
-            memcpy(dataRaw.data(), dataBytes.data(), dataSize);
+        decodes.push_back({ layers.size(), dataJson.get<size_t>(), compression });
+        layers.emplace_back(std::move(layer));
+    }
+
+    //GIDs are decoded straight into each layer's storage, the base64 string is released as soon as it is decoded
+    auto decode = [&](size_t i) {
+        auto& item = decodes[i];
+        auto& layer = layers[item.layer];
+
+        std::string dataString = std::move(m_layerData[item.data]);
+        decodeLayerData(dataString, item.compression, layer.data.data(), layer.data.size());
+    };
+
+    if (m_threadPool != nullptr) {
+        m_threadPool->parallelFor(decodes.size(), decode);
+    } else {
+        for (size_t i = 0; i < decodes.size(); i++) {
+            decode(i);
         }
+    }
+}
+
+//decodes base64 in blocks small enough to stay in cache, feeding each block to zlib, which inflates straight into out
+void Tiled::decodeLayerData(const std::string& base64, Compression compression, LayerData* out, size_t count) {
+    size_t size = count * sizeof(uint32_t);
 
-        std::vector<LayerData> data;
+    if (compression == Compression::None) {
+        size_t padding = 0;
+        while (padding < base64.size() && padding < 2 && base64[base64.size() - 1 - padding] == '=') padding++;
 
-        for (auto datum : dataRaw) {
-            data.emplace_back(datum);
+        if (base64.size() % 4 != 0 || (base64.size() / 4 * 3) - padding != size) {
+            throw std::runtime_error("Layer data does not match layer size");
         }
 
-        layer.data = std::move(data);
-        layer.width = item["width"].get<int32_t>();
-        layer.height = item["height"].get<int32_t>();
-        layer.id = item["id"].get<int32_t>();
+        size_t outSize = size;
+        if (base64_decode(base64.data(), base64.size(), reinterpret_cast<char*>(out), &outSize, 0) != 1 || outSize != size) {
+            throw std::runtime_error("Invalid base64 layer data");
+        }
 
-        layers.emplace_back(std::move(layer));
+        return;
     }
-}
 
-std::vector<uint32_t> Tiled::decompress(std::vector<char>& bytes) {
-    std::vector<char> decompressed = decompressZLIB(bytes);
-    std::vector<uint32_t> result;
-    result.resize(decompressed.size() / sizeof(uint32_t));
-    memcpy(result.data(), decompressed.data(), decompressed.size());
-    return result;
-}
\ No newline at end of file
+#ifdef ROGUELIKE_USE_LIBDEFLATE
+    //libdeflate cannot inflate a stream in pieces, so the compressed bytes are decoded whole and inflated in one call
+    std::vector<char> compressed(base64.size() / 4 * 3);
+    size_t compressedSize = compressed.size();
+
+    if (base64_decode(base64.data(), base64.size(), compressed.data(), &compressedSize, 0) != 1) {
+        throw std::runtime_error("Invalid base64 layer data");
+    }
+
+    decompressZLIB(compressed.data(), compressedSize, reinterpret_cast<char*>(out), size);
+#else
+    ZLIBInflater inflater(out, size);
+    base64_state state;
+    base64_stream_decode_init(&state, 0);
+
+    //whole quads of input decode to whole triplets, so nothing is carried between blocks
+    char block[BASE64_BLOCK / 4 * 3];
+
+    for (size_t position = 0; position < base64.size(); position += BASE64_BLOCK) {
+        size_t length = std::min<size_t>(BASE64_BLOCK, base64.size() - position);
+        size_t blockSize = sizeof(block);
+
+        if (base64_stream_decode(&state, &base64[position], length, block, &blockSize) != 1) {
+            throw std::runtime_error("Invalid base64 layer data");
+        }
+
+        inflater.write(block, blockSize);
+    }
+
+    inflater.finish();
+#endif
+}
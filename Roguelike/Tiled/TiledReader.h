@@ -4,6 +4,10 @@
 #include <nlohmann/json.hpp>
 #include <unordered_map>
 
+namespace SEngine {
+    class ThreadPool;
+}
+
 class Tiled {
 public:
     enum class Compression {
@@ -11,10 +15,16 @@ public:
         Zlib
     };
 
+    struct Frame {
+        int32_t tileID;
+        int32_t duration;   //milliseconds
+    };
+
     struct Tile {
         int32_t id;
         int32_t imageWidth;
         int32_t imageHeight;
+        std::vector<Frame> animation;
     };
 
     struct Tileset {
@@ -33,13 +43,24 @@ public:
 
     };
 
+    //the raw Tiled GID, with the flip flags in the top 3 bits and the tile id below them
     struct LayerData {
-        bool flipX;
-        bool flipY;
-        bool flipDiagonal;
-        uint32_t id;
+        static constexpr uint32_t FlipXBit = 0x80000000;
+        static constexpr uint32_t FlipYBit = 0x40000000;
+        static constexpr uint32_t FlipDiagonalBit = 0x20000000;
+        static constexpr uint32_t FlipMask = FlipXBit | FlipYBit | FlipDiagonalBit;
+        static constexpr uint32_t IDMask = ~FlipMask;
+
+        uint32_t raw;
 
-        LayerData(uint32_t dataRaw);
+        LayerData() = default;
+        LayerData(uint32_t dataRaw) : raw(dataRaw) {}
+
+        uint32_t id() const { return raw & IDMask; }
+        bool flipX() const { return (raw & FlipXBit) != 0; }
+        bool flipY() const { return (raw & FlipYBit) != 0; }
+        bool flipDiagonal() const { return (raw & FlipDiagonalBit) != 0; }
+        bool flipped() const { return (raw & FlipMask) != 0; }
     };
 
     struct Layer {
@@ -60,7 +81,8 @@ public:
         std::vector<Tileset> tilesets;
     };
 
-    Tiled(const std::string& root);
+    //layers are decoded in parallel on threadPool when one is given
+    Tiled(const std::string& root, SEngine::ThreadPool* threadPool = nullptr);
     Tiled(const Tiled& other) = delete;
     Tiled& operator = (const Tiled& other) = delete;
     Tiled(Tiled&& other) = default;
@@ -71,9 +93,19 @@ public:
 
 private:
     std::string m_root;
+    SEngine::ThreadPool* m_threadPool;
     std::vector<std::unique_ptr<Tileset>> m_tilesets;
     std::unordered_map<std::string, Tileset*> m_tilesetMap;
     std::vector<std::unique_ptr<Map>> m_maps;
+    std::vector<std::string> m_layerData;   //"data" strings of the json being loaded, replaced in the json by their index
+
+    struct LayerDecode {
+        size_t layer;
+        size_t data;
+        Compression compression;
+    };
+
+    void parseFile(const std::string& path, nlohmann::json& json);
 
     Tileset loadTileset(nlohmann::json& json);
     Tileset& loadTileset(const std::string& name, nlohmann::json& json);
@@ -81,6 +113,7 @@ private:
     Map& loadMap(nlohmann::json& json);
     void loadMapTilesets(std::vector<Tileset>& tilesets, nlohmann::json& json);
     void loadTiles(std::vector<Tile>& tiles, nlohmann::json& json);
+    void loadAnimation(std::vector<Frame>& frames, nlohmann::json& json);
     void loadMapLayers(std::vector<Layer>& layers, nlohmann::json& json);
-    std::vector<uint32_t> decompress(std::vector<char>& bytes);
+    void decodeLayerData(const std::string& base64, Compression compression, LayerData* out, size_t count);
 };
\ No newline at end of file
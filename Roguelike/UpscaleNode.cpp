@@ -0,0 +1,107 @@
+#include "UpscaleNode.h"
+
+#include <algorithm>
+
+UpscaleNode::UpscaleNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, SEngine::AcquireNode& acquireNode, RenderTarget& target)
+    : SEngine::RenderGraph::Node(graph, engine.getGraphics().graphicsQueue()) {
+    m_graphics = &engine.getGraphics();
+    m_acquireNode = &acquireNode;
+    m_target = &target;
+
+    if (!target.offscreen()) throw std::runtime_error("UpscaleNode requires an offscreen render target");
+
+    if (!(m_graphics->swapchainUsage() & vk::ImageUsageFlagBits::eTransferDst)) {
+        throw std::runtime_error("Swapchain does not support transfer destination usage");
+    }
+
+    auto features = m_graphics->physicalDevice().getFormatProperties(target.format()).optimalTilingFeatures;
+
+    if (!(features & vk::FormatFeatureFlagBits::eBlitSrc) || !(features & vk::FormatFeatureFlagBits::eBlitDst)) {
+        throw std::runtime_error("Swapchain format does not support blits");
+    }
+
+    m_sourceUsage = std::make_unique<SEngine::RenderGraph::ImageUsage>(
+        *this, vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer
+    );
+
+    m_imageUsage = std::make_unique<SEngine::RenderGraph::ImageUsage>(
+        *this, vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits::eTransferWrite, vk::PipelineStageFlagBits::eTransfer
+    );
+}
+
+void UpscaleNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
+    uint32_t imageIndex = m_acquireNode->swapchainIndex();
+    vk::Image swapchainImage = m_graphics->swapchainImages()[imageIndex];
+    vk::Extent2D swapchainExtent = m_graphics->swapchainExtent();
+    vk::Extent2D extent = m_target->extent();
+
+    //the window can be smaller than one scaled pixel, and the target is resized after the swapchain
+    uint32_t scale = std::min({ m_target->scale(), swapchainExtent.width / extent.width, swapchainExtent.height / extent.height });
+    scale = std::max<uint32_t>(scale, 1);
+
+    vk::ImageSubresourceRange subresource = {};
+    subresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    subresource.layerCount = 1;
+    subresource.levelCount = 1;
+
+    vk::ImageMemoryBarrier barrier = {};
+    barrier.image = swapchainImage;
+    barrier.oldLayout = vk::ImageLayout::eUndefined;
+    barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = subresource;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {},
+        nullptr,
+        nullptr,
+        barrier
+    );
+
+    //the swapchain is rarely an exact multiple of the scale, the leftover border is cleared to black
+    vk::ClearColorValue clear = {};
+    commandBuffer.clearColorImage(swapchainImage, vk::ImageLayout::eTransferDstOptimal, clear, subresource);
+
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {},
+        nullptr,
+        nullptr,
+        barrier
+    );
+
+    int32_t swapchainWidth = static_cast<int32_t>(swapchainExtent.width);
+    int32_t swapchainHeight = static_cast<int32_t>(swapchainExtent.height);
+    int32_t scaledWidth = static_cast<int32_t>(extent.width * scale);
+    int32_t scaledHeight = static_cast<int32_t>(extent.height * scale);
+    int32_t offsetX = std::max<int32_t>(0, (swapchainWidth - scaledWidth) / 2);
+    int32_t offsetY = std::max<int32_t>(0, (swapchainHeight - scaledHeight) / 2);
+
+    vk::ImageBlit blit = {};
+    blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1] = vk::Offset3D{ static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 };
+    blit.dstSubresource = blit.srcSubresource;
+    blit.dstOffsets[0] = vk::Offset3D{ offsetX, offsetY, 0 };
+    blit.dstOffsets[1] = vk::Offset3D{ std::min(offsetX + scaledWidth, swapchainWidth), std::min(offsetY + scaledHeight, swapchainHeight), 1 };
+
+    //the last node to draw into the target already left it in the transfer src layout
+    commandBuffer.blitImage(
+        m_target->image(m_target->imageIndex()), vk::ImageLayout::eTransferSrcOptimal,
+        swapchainImage, vk::ImageLayout::eTransferDstOptimal,
+        blit, vk::Filter::eNearest
+    );
+
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout = vk::ImageLayout::ePresentSrcKHR;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = {};
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {},
+        nullptr,
+        nullptr,
+        barrier
+    );
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SimpleEngine/SimpleEngine.h>
+#include <SimpleEngine/RenderGraph/RenderGraph.h>
+#include <SimpleEngine/RenderGraph/AcquireNode.h>
+
+#include "RenderTarget.h"
+
+//scales an offscreen RenderTarget into the swapchain by a whole number, keeping pixel art sharp
+class UpscaleNode : public SEngine::RenderGraph::Node {
+public:
+    UpscaleNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, SEngine::AcquireNode& acquireNode, RenderTarget& target);
+
+    //the render target, read as a transfer source
+    SEngine::RenderGraph::ImageUsage& sourceUsage() { return *m_sourceUsage; }
+    //the swapchain image, written as a transfer destination
+    SEngine::RenderGraph::ImageUsage& imageUsage() { return *m_imageUsage; }
+
+    void preRender(uint32_t currentFrame) {}
+    void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
+    void postRender(uint32_t currentFrame) {}
+
+private:
+    SEngine::Graphics* m_graphics;
+    SEngine::AcquireNode* m_acquireNode;
+    RenderTarget* m_target;
+
+    std::unique_ptr<SEngine::RenderGraph::ImageUsage> m_sourceUsage;
+    std::unique_ptr<SEngine::RenderGraph::ImageUsage> m_imageUsage;
+};
@@ -1,33 +1,131 @@
 #include <iostream>
+#include <string>
 
 #include <SimpleEngine/SimpleEngine.h>
 #include <SimpleEngine/RenderGraph/AcquireNode.h>
 #include <SimpleEngine/RenderGraph/PresentNode.h>
 #include <SimpleEngine/RenderGraph/TransferNode.h>
+#include <SimpleEngine/RenderGraph/DefragmentNode.h>
 #include <SimpleEngine/FPSCounter.h>
 
 #include "RenderNode.h"
+#include "SpriteNode.h"
+#include "RenderTarget.h"
+#include "UpscaleNode.h"
 #include "Tiled/TiledReader.h"
 #include "Freecam.h"
 
-int main() {
+struct Options {
+    SEngine::SwapchainSettings swapchainSettings;
+    uint32_t framesInFlight = 2;
+    RenderNode::TileRenderMode renderMode = RenderNode::TileRenderMode::Instances;
+    uint32_t pixelScale = 1;
+    bool renderOnDemand = false;
+    bool benchmark = false;
+};
+
+static vk::PresentModeKHR parsePresentMode(const std::string& name) {
+    if (name == "fifo") return vk::PresentModeKHR::eFifo;
+    if (name == "fifo-relaxed") return vk::PresentModeKHR::eFifoRelaxed;
+    if (name == "mailbox") return vk::PresentModeKHR::eMailbox;
+    if (name == "immediate") return vk::PresentModeKHR::eImmediate;
+    throw std::runtime_error("Unknown present mode: " + name);
+}
+
+//--benchmark                   uncapped frame rate (immediate, falling back to mailbox)
+//--present-mode=<mode>         fifo, fifo-relaxed, mailbox or immediate
+//--images=<count>              requested swapchain image count
+//--frames-in-flight=<count>    frames the CPU may record ahead of the GPU
+//--tile-texture                render the map with the tile ID texture mode
+//--pixel-scale=<scale>         render at 1/scale resolution, then upscale into the window
+//--on-demand                   only render frames when something changed
+static Options parseOptions(int argc, char** argv) {
+    Options options = {};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t split = arg.find('=');
+        std::string name = arg.substr(0, split);
+        std::string value = split != std::string::npos ? arg.substr(split + 1) : "";
+
+        if (name == "--benchmark") {
+            options.benchmark = true;
+            options.swapchainSettings.presentModes = { vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eMailbox };
+            options.swapchainSettings.imageCount = 3;
+        } else if (name == "--present-mode") {
+            options.swapchainSettings.presentModes = { parsePresentMode(value) };
+        } else if (name == "--images") {
+            options.swapchainSettings.imageCount = static_cast<uint32_t>(std::stoul(value));
+        } else if (name == "--frames-in-flight") {
+            options.framesInFlight = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(value)));
+        } else if (name == "--tile-texture") {
+            options.renderMode = RenderNode::TileRenderMode::TileTexture;
+        } else if (name == "--pixel-scale") {
+            options.pixelScale = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(value)));
+        } else if (name == "--on-demand") {
+            options.renderOnDemand = true;
+        } else {
+            std::cout << "Unknown argument: " << arg << "\n";
+        }
+    }
+
+    return options;
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+
     SEngine::Engine engine;
     SEngine::Window window(800, 600, "Roguelike");
-    SEngine::Graphics graphics(window, "Roguelike");
-    SEngine::RenderGraph renderGraph(graphics.device(), 2);
+    SEngine::Graphics graphics(window, "Roguelike", options.swapchainSettings);
+
+    //the requested modes fall back when unsupported, so report the one actually used
+    if (options.benchmark) {
+        std::cout << "Present mode: " << vk::to_string(graphics.presentMode()) << "\n";
+    }
+
+    std::unique_ptr<RenderTarget> target;   //outlives the nodes connected to it, but its images must be released before the graph goes
+    SEngine::RenderGraph renderGraph(graphics.device(), options.framesInFlight);
 
     engine.setWindow(window);
     engine.setGraphics(graphics);
     engine.setRenderGraph(renderGraph);
+    engine.setRenderOnDemand(options.renderOnDemand);
 
     auto& acquireNode = renderGraph.addNode<SEngine::AcquireNode>(engine, renderGraph);
-    auto& presentNode = renderGraph.addNode<SEngine::PresentNode>(engine, renderGraph, vk::PipelineStageFlagBits::eColorAttachmentOutput, acquireNode);
+
+    if (options.pixelScale > 1) {
+        target = std::make_unique<RenderTarget>(engine, options.pixelScale);
+    } else {
+        target = std::make_unique<RenderTarget>(engine, acquireNode);
+    }
+
+    vk::PipelineStageFlagBits presentStage = target->offscreen() ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eColorAttachmentOutput;
+
+    auto& presentNode = renderGraph.addNode<SEngine::PresentNode>(engine, renderGraph, presentStage, acquireNode);
     auto& transferNode = renderGraph.addNode<SEngine::TransferNode>(engine, renderGraph);
-    auto& renderNode = renderGraph.addNode<RenderNode>(engine, renderGraph, acquireNode, transferNode);
+    auto& renderNode = renderGraph.addNode<RenderNode>(engine, renderGraph, *target, transferNode);
+    auto& spriteNode = renderGraph.addNode<SpriteNode>(engine, renderGraph, *target, transferNode);
+    auto& defragmentNode = renderGraph.addNode<SEngine::DefragmentNode>(engine, renderGraph, transferNode, 16 * 1024 * 1024, 60);
+
+    if (target->offscreen()) {
+        auto& upscaleNode = renderGraph.addNode<UpscaleNode>(engine, renderGraph, acquireNode, *target);
+
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(renderNode.imageUsage(), spriteNode.imageUsage()));
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(spriteNode.imageUsage(), upscaleNode.sourceUsage()));
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(acquireNode.imageUsage(), upscaleNode.imageUsage()));
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(upscaleNode.imageUsage(), presentNode.imageUsage()));
+    } else {
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(acquireNode.imageUsage(), renderNode.imageUsage()));
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(renderNode.imageUsage(), spriteNode.imageUsage()));
+        renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(spriteNode.imageUsage(), presentNode.imageUsage()));
+    }
 
-    renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(acquireNode.imageUsage(), renderNode.imageUsage()));
-    renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(renderNode.imageUsage(), presentNode.imageUsage()));
     renderGraph.addEdge(SEngine::RenderGraph::BufferEdge(transferNode.bufferUsage(), renderNode.bufferUsage()));
+    renderGraph.addEdge(SEngine::RenderGraph::BufferEdge(transferNode.bufferUsage(), renderNode.computeUsage()));
+    renderGraph.addEdge(SEngine::RenderGraph::BufferEdge(transferNode.bufferUsage(), spriteNode.bufferUsage()));
+    renderGraph.addEdge(SEngine::RenderGraph::BufferEdge(transferNode.bufferUsage(), spriteNode.uniformUsage()));
+    renderGraph.addEdge(SEngine::RenderGraph::BufferEdge(transferNode.bufferUsage(), defragmentNode.bufferUsage()));
     renderGraph.addEdge(SEngine::RenderGraph::ImageEdge(transferNode.imageUsage(), renderNode.textureUsage()));
 
     renderGraph.bake();
@@ -42,11 +140,15 @@ int main() {
     freecam.setSpeed(50);
     engine.addSystem(freecam);
 
-    Tiled tiles("data");
-    auto& tileset = tiles.loadTileset("roguelike_tilesheet_main.json");
+    Tiled tiles("data", &engine.threadPool());
     auto& map = tiles.loadMap("sample_map.json");
     renderNode.setCamera(camera);
-    renderNode.loadMap(tileset, map);
+    renderNode.setRenderMode(options.renderMode);
+    renderNode.loadMap(map);
+    spriteNode.setCamera(camera);
+    spriteNode.setSpritesheet(renderNode.spritesheetView());
 
     engine.run();
+
+    target->releaseImages();
 }
\ No newline at end of file
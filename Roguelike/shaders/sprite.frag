@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec3 inUV;
+layout(location = 1) in vec4 inTint;
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 1) uniform sampler s;
+layout(set = 0, binding = 2) uniform texture2DArray t;
+
+void main() {
+    outColor = texture(sampler2DArray(t, s), inUV) * inTint;
+}
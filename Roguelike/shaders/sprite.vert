@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in uint inTile;
+layout(location = 2) in vec4 inTint;
+
+layout(location = 0) out vec3 fragUV;
+layout(location = 1) out vec4 fragTint;
+
+layout(set = 0, binding = 0) uniform UniformData {
+    mat4 proj;
+    mat4 view;
+} ubo;
+
+const vec2 corners[6] = vec2[](
+    vec2(0, 0),
+    vec2(1, 0),
+    vec2(0, 1),
+    vec2(1, 0),
+    vec2(1, 1),
+    vec2(0, 1)
+);
+
+void main() {
+    vec2 corner = corners[gl_VertexIndex];
+    uint id = inTile & 0x1FFFFFFFu;
+
+    vec2 uv = corner;
+    if ((inTile & 0x20000000u) != 0u) uv = uv.yx;
+    if ((inTile & 0x80000000u) != 0u) uv.x = 1.0 - uv.x;
+    if ((inTile & 0x40000000u) != 0u) uv.y = 1.0 - uv.y;
+
+    gl_Position = ubo.proj * ubo.view * vec4(inPosition.xy + corner, inPosition.z, 1.0);
+    fragUV = vec3(uv, float(id - 1u));
+    fragTint = inTint;
+}
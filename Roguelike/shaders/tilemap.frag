@@ -0,0 +1,66 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 0) out vec4 outColor;
+
+//set per pipeline variant, disabled features are compiled out instead of branched on
+layout(constant_id = 0) const bool FLIP_TILES = true;
+layout(constant_id = 1) const bool ANIMATED_TILES = true;
+
+layout(set = 0, binding = 0) uniform UniformData {
+    mat4 proj;
+    mat4 view;
+    uint time;
+} ubo;
+
+layout(set = 0, binding = 1) uniform sampler s;
+layout(set = 0, binding = 2) uniform texture2DArray t;
+layout(set = 0, binding = 3) uniform utexture2DArray tileIDs;
+layout(set = 0, binding = 4) readonly buffer AnimationData {
+    uvec2 entries[];
+} animations;
+
+layout(push_constant) uniform LayerData {
+    ivec2 size;
+    uint layer;
+    float depth;
+} layerData;
+
+//entries[layer] is (first frame, frame count), each frame is (array layer, end time)
+uint animate(uint layer) {
+    uvec2 animation = animations.entries[layer];
+    if (animation.y == 0u) return layer;
+
+    uint duration = animations.entries[animation.x + animation.y - 1u].y;
+    uint time = ubo.time % duration;
+
+    for (uint i = 0u; i < animation.y - 1u; i++) {
+        uvec2 frame = animations.entries[animation.x + i];
+        if (time < frame.y) return frame.x;
+    }
+
+    return animations.entries[animation.x + animation.y - 1u].x;
+}
+
+void main() {
+    //interpolation can land exactly on the far edge of the layer quad
+    ivec2 cell = clamp(ivec2(floor(inPosition)), ivec2(0), layerData.size - 1);
+    uint gid = texelFetch(usampler2DArray(tileIDs, s), ivec3(cell, layerData.layer), 0).r;
+    uint id = gid & 0x1FFFFFFFu;
+
+    if (id == 0u) {
+        discard;
+    }
+
+    vec2 uv = fract(inPosition);
+
+    if (FLIP_TILES) {
+        if ((gid & 0x20000000u) != 0u) uv = uv.yx;
+        if ((gid & 0x80000000u) != 0u) uv.x = 1.0 - uv.x;
+        if ((gid & 0x40000000u) != 0u) uv.y = 1.0 - uv.y;
+    }
+
+    uint layer = ANIMATED_TILES ? animate(id - 1u) : id - 1u;
+
+    outColor = textureLod(sampler2DArray(t, s), vec3(uv, float(layer)), 0.0);
+}
@@ -0,0 +1,30 @@
+#version 450
+
+layout(location = 0) out vec2 fragPosition;
+
+layout(set = 0, binding = 0) uniform UniformData {
+    mat4 proj;
+    mat4 view;
+    uint time;
+} ubo;
+
+layout(push_constant) uniform LayerData {
+    ivec2 size;
+    uint layer;
+    float depth;
+} layerData;
+
+const vec2 corners[6] = vec2[](
+    vec2(0, 0),
+    vec2(1, 0),
+    vec2(0, 1),
+    vec2(1, 0),
+    vec2(1, 1),
+    vec2(0, 1)
+);
+
+void main() {
+    vec2 position = corners[gl_VertexIndex] * vec2(layerData.size);
+    gl_Position = ubo.proj * ubo.view * vec4(position, layerData.depth, 1.0);
+    fragPosition = position;
+}
@@ -1,16 +1,56 @@
 #version 450
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inUV;
+layout(location = 0) in ivec2 inPosition;
+layout(location = 1) in uvec2 inTile;
 
 layout(location = 0) out vec3 fragUV;
 
+//set per pipeline variant, disabled features are compiled out instead of branched on
+layout(constant_id = 0) const bool FLIP_TILES = true;
+layout(constant_id = 1) const bool ANIMATED_TILES = true;
+
 layout(set = 0, binding = 0) uniform UniformData {
     mat4 proj;
     mat4 view;
+    uint time;
 } ubo;
 
+layout(set = 0, binding = 4) readonly buffer AnimationData {
+    uvec2 entries[];
+} animations;
+
+//indexed as 0 1 2, 1 3 2
+const vec2 corners[4] = vec2[](
+    vec2(0, 0), vec2(1, 0), vec2(0, 1), vec2(1, 1)
+);
+
+//entries[layer] is (first frame, frame count), each frame is (array layer, end time)
+uint animate(uint layer) {
+    uvec2 animation = animations.entries[layer];
+    if (animation.y == 0u) return layer;
+
+    uint duration = animations.entries[animation.x + animation.y - 1u].y;
+    uint time = ubo.time % duration;
+
+    for (uint i = 0u; i < animation.y - 1u; i++) {
+        uvec2 frame = animations.entries[animation.x + i];
+        if (time < frame.y) return frame.x;
+    }
+
+    return animations.entries[animation.x + animation.y - 1u].x;
+}
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * vec4(inPosition, 1.0);
-    fragUV = inUV;
+    vec2 corner = corners[gl_VertexIndex];
+    uint depth = inTile.x & 0x1FFFu;
+    vec2 uv = corner;
+
+    if (FLIP_TILES) {
+        if ((inTile.x & 0x2000u) != 0u) uv = uv.yx;
+        if ((inTile.x & 0x8000u) != 0u) uv.x = 1.0 - uv.x;
+        if ((inTile.x & 0x4000u) != 0u) uv.y = 1.0 - uv.y;
+    }
+
+    gl_Position = ubo.proj * ubo.view * vec4(vec2(inPosition) + corner, float(depth), 1.0);
+    fragUV = vec3(uv, ANIMATED_TILES ? animate(inTile.y) : inTile.y);
 }
\ No newline at end of file
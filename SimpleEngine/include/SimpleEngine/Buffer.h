@@ -1,10 +1,13 @@
 #pragma once
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan_raii.hpp>
+#include <entt/signal/sigh.hpp>
+#include "SimpleEngine/MemoryManager.h"
 
 namespace SEngine {
 class Engine;
 class RenderGraph;
+class DefragmentNode;
 
 struct BufferState {
     Engine* engine;
@@ -21,18 +24,31 @@ struct BufferState {
 };
 
 class Buffer {
+    friend class DefragmentNode;
 public:
-    Buffer(Engine& engine, const vk::BufferCreateInfo& info, const VmaAllocationCreateInfo& allocInfo);
+    Buffer(Engine& engine, const vk::BufferCreateInfo& info, const VmaAllocationCreateInfo& allocInfo, MemoryCategory category = MemoryCategory::Other, const std::string& label = "");
     ~Buffer();
 
     const vk::Buffer& buffer() const { return *m_bufferState->buffer; }
     void* getMapping() const;
     size_t size() const { return m_bufferState->size; }
     size_t offset() const { return m_allocationInfo.offset; }
+    VmaAllocation allocation() const { return m_bufferState->allocation; }
+    bool movable() const { return m_movable; }
+
+    entt::sink<void(Buffer&)>& onRelocated() { return m_onRelocated; }
 
 private:
     Engine* m_engine;
     std::unique_ptr<BufferState> m_bufferState;
     VmaAllocationInfo m_allocationInfo;
+    vk::BufferCreateInfo m_info;
+    std::vector<uint32_t> m_queueFamilyIndices;
+    bool m_movable;
+
+    entt::sigh<void(Buffer&)> m_onRelocatedSignal;
+    entt::sink<void(Buffer&)> m_onRelocated;
+
+    void relocate();
 };
 }
\ No newline at end of file
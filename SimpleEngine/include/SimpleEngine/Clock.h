@@ -10,6 +10,8 @@ public:
     Clock& operator = (Clock&& other) = delete;
 
     void update(float currentTime);
+    //starts a new frame at currentTime with no delta, so time spent idle is not seen as one long frame
+    void reset(float currentTime);
 
     float deltaTime();
     float currentTime();
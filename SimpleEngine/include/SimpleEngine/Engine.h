@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include <vector>
+#include <cstdint>
 
 namespace SEngine {
 class Window;
@@ -8,6 +9,7 @@ class Graphics;
 class RenderGraph;
 class Clock;
 class ISystem;
+class ThreadPool;
 
 class Engine {
 public:
@@ -20,6 +22,7 @@ public:
     ~Engine();
 
     Clock& renderClock() const { return *m_renderClock; }
+    ThreadPool& threadPool() const { return *m_threadPool; }
 
     void setWindow(Window& window);
     Window& getWindow();
@@ -32,6 +35,12 @@ public:
 
     void addSystem(ISystem& system);
 
+    //when enabled, frames are only rendered while a node or system is dirty. otherwise the engine
+    //sleeps until input arrives or idleTimeout seconds pass
+    void setRenderOnDemand(bool enabled, double idleTimeout = 0.25);
+    //renders the next frame even if nothing reports dirty
+    void requestRender();
+
     void run();
 
 private:
@@ -39,8 +48,13 @@ private:
     Graphics* m_graphics;
     RenderGraph* m_renderGraph;
     bool m_shouldExit;
+    bool m_renderOnDemand;
+    bool m_renderRequested;
+    double m_idleTimeout;
+    uint64_t m_swapchainVersion;
     std::vector<ISystem*> m_renderSystems;
 
     std::unique_ptr<Clock> m_renderClock;
+    std::unique_ptr<ThreadPool> m_threadPool;
 };
 }
\ No newline at end of file
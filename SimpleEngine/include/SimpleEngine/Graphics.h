@@ -7,6 +7,7 @@
 
 namespace SEngine {
 class Window;
+class RenderGraph;
 
 struct QueueInfo {
     vk::raii::Device& device;
@@ -19,23 +20,49 @@ struct QueueInfo {
     }
 };
 
+struct SwapchainSettings {
+    //in order of preference, FIFO is used when none of them are supported
+    std::vector<vk::PresentModeKHR> presentModes = { vk::PresentModeKHR::eFifo };
+    uint32_t imageCount = 2;
+};
+
 class Graphics {
 public:
-    Graphics(Window& window, const std::string& appName);
+    Graphics(Window& window, const std::string& appName, const SwapchainSettings& swapchainSettings = {});
     Graphics(const Graphics& other) = delete;
     Graphics& operator = (const Graphics& other) = delete;
     Graphics(Graphics&& other) = default;
     Graphics& operator = (Graphics&& other) = default;
+    ~Graphics();
 
     vk::raii::PhysicalDevice& physicalDevice() const { return *m_physicalDevice; }
     vk::raii::Device& device() const { return *m_device; }
     MemoryManager& memory() const { return *m_memoryManager; }
+    vk::raii::PipelineCache& pipelineCache() const { return *m_pipelineCache; }
+
+    void savePipelineCache();
+
+    //when set, retired swapchain resources are destroyed through the render graph instead of waiting for the device to idle
+    void setRenderGraph(RenderGraph& renderGraph);
 
     vk::raii::SwapchainKHR* swapchain() const { return m_swapchain.get(); }
     const std::vector<vk::Image>& swapchainImages() const { return m_swapchainImages; }
     const std::vector<vk::raii::ImageView>& swapchainImageViews() const { return m_swapchainImageViews; }
     vk::Format swapchainFormat() const { return m_swapchainFormat; }
     vk::Extent2D swapchainExtent() const { return m_swapchainExtent; }
+    vk::ImageUsageFlags swapchainUsage() const { return m_swapchainUsage; }
+    vk::PresentModeKHR presentMode() const { return m_presentMode; }
+    //incremented every time the swapchain is recreated
+    uint64_t swapchainVersion() const { return m_swapchainVersion; }
+
+    //true when VK_KHR_dynamic_rendering was available and enabled on the device
+    bool dynamicRendering() const { return m_dynamicRendering; }
+    //true when VK_KHR_draw_indirect_count was available and enabled on the device
+    bool drawIndirectCount() const { return m_drawIndirectCount; }
+    //true when indirect draws may use a drawCount greater than 1
+    bool multiDrawIndirect() const { return m_multiDrawIndirect; }
+    //true when indirect draws may use a non-zero firstInstance
+    bool drawIndirectFirstInstance() const { return m_drawIndirectFirstInstance; }
 
     QueueInfo& graphicsQueue() { return *m_graphicsQueue; }
     QueueInfo& presentQueue() { return *m_presentQueue; }
@@ -53,6 +80,7 @@ private:
     };
 
     Window* m_window;
+    RenderGraph* m_renderGraph;
 
     std::unique_ptr<vk::raii::Context> m_context;
     std::unique_ptr<vk::raii::Instance> m_instance;
@@ -65,9 +93,19 @@ private:
     std::unique_ptr<QueueInfo> m_presentQueue;
     std::unique_ptr<QueueInfo> m_transferQueue;
 
+    SwapchainSettings m_swapchainSettings;
+    vk::PresentModeKHR m_presentMode;
+    bool m_dynamicRendering;
+    bool m_drawIndirectCount;
+    bool m_multiDrawIndirect;
+    bool m_drawIndirectFirstInstance;
     std::unique_ptr<MemoryManager> m_memoryManager;
+    std::unique_ptr<vk::raii::PipelineCache> m_pipelineCache;
+    std::string m_pipelineCachePath;
     vk::Format m_swapchainFormat;
     vk::Extent2D m_swapchainExtent;
+    vk::ImageUsageFlags m_swapchainUsage;
+    uint64_t m_swapchainVersion;
     std::vector<vk::Image> m_swapchainImages;
     std::vector<vk::raii::ImageView> m_swapchainImageViews;
 
@@ -81,13 +119,15 @@ private:
     QueueFamilies evaluatePhysicalDevice(vk::raii::PhysicalDevice& device, bool requireDiscrete);
     void selectPhysicalDevice();
     void createDevice(vk::raii::PhysicalDevice& physicalDevice, QueueFamilies& queueFamilies);
+    void createPipelineCache();
 
     void recreateSwapchain(int32_t width, int32_t height);
     void createImageViews();
     void createSwapchain();
+    void retireSwapchain(std::unique_ptr<vk::raii::SwapchainKHR>&& swapchain);
 
     vk::Format chooseFormat(std::vector<vk::SurfaceFormatKHR>& formats);
-    vk::PresentModeKHR choosePresentMode(std::vector<vk::PresentModeKHR>& formats);
+    vk::PresentModeKHR choosePresentMode(std::vector<vk::PresentModeKHR>& modes);
     vk::Extent2D chooseExtent(vk::SurfaceCapabilitiesKHR& capabilities);
 };
 }
\ No newline at end of file
@@ -11,6 +11,9 @@ public:
 
     virtual void update(Clock& clock) = 0;
 
+    //systems that change what is drawn in ways the render graph can't see return true
+    virtual bool isDirty() const { return false; }
+
 private:
     size_t m_priority;
 };
@@ -2,6 +2,7 @@
 #include <vk_mem_alloc.h>
 #include <memory>
 #include <vulkan/vulkan_raii.hpp>
+#include "SimpleEngine/MemoryManager.h"
 
 namespace SEngine {
     class Engine;
@@ -24,7 +25,7 @@ namespace SEngine {
 
     class Image {
     public:
-        Image(Engine& engine, const vk::ImageCreateInfo& info, const VmaAllocationCreateInfo& allocInfo);
+        Image(Engine& engine, const vk::ImageCreateInfo& info, const VmaAllocationCreateInfo& allocInfo, MemoryCategory category = MemoryCategory::Other, const std::string& label = "");
         Image(const Image& other) = delete;
         Image& operator = (const Image& other) = delete;
         Image(Image&& other) = default;
@@ -1,8 +1,31 @@
 #pragma once
 #include <vulkan/vulkan_raii.hpp>
 #include <vk_mem_alloc.h>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <string>
 
 namespace SEngine {
+class Buffer;
+
+enum class MemoryCategory {
+    Other,
+    Staging,
+    Vertex,
+    Uniform,
+    Texture,
+    Count
+};
+
+struct MemoryStats {
+    size_t allocationCount;
+    size_t frameAllocations;
+    size_t frameFrees;
+    vk::DeviceSize usedBytes;
+    vk::DeviceSize peakBytes;
+};
+
 class MemoryManager {
 public:
     MemoryManager(const vk::PhysicalDevice& physicalDevice, const vk::Device& device);
@@ -14,9 +37,48 @@ public:
 
     VmaAllocator allocator() const { return m_allocator; }
 
+    void addMovableBuffer(Buffer& buffer);
+    void removeMovableBuffer(Buffer& buffer);
+    const std::unordered_map<VmaAllocation, Buffer*>& movableBuffers() const { return m_movableBuffers; }
+
+    //an open defragmentation pass keeps its block vectors locked and its old ranges in use until it ends,
+    //so new allocations get dedicated memory and frees are held back until then
+    void beginDefragmentation();
+    void endDefragmentation();
+    bool defragmenting() const { return m_defragmenting; }
+    void prepareAllocation(VmaAllocationCreateInfo& info) const;
+    void freeAllocation(VmaAllocation allocation);
+
+    void trackAllocation(VmaAllocation allocation, MemoryCategory category, vk::DeviceSize size, const std::string& label);
+    void untrackAllocation(VmaAllocation allocation);
+    void newFrame();
+
+    const MemoryStats& stats(MemoryCategory category) const { return m_stats[static_cast<size_t>(category)]; }
+    std::string buildStatsString(bool detailedMap) const;
+
+    static const char* categoryName(MemoryCategory category);
+
 private:
+    struct AllocationRecord {
+        MemoryCategory category;
+        vk::DeviceSize size;
+        std::string label;
+    };
+
+    struct FrameCounts {
+        size_t allocations;
+        size_t frees;
+    };
+
     VmaAllocator m_allocator;
+    std::unordered_map<VmaAllocation, Buffer*> m_movableBuffers;
+    std::unordered_map<VmaAllocation, AllocationRecord> m_allocations;
+    std::array<MemoryStats, static_cast<size_t>(MemoryCategory::Count)> m_stats;
+    std::array<FrameCounts, static_cast<size_t>(MemoryCategory::Count)> m_frameCounts;
+    bool m_defragmenting;
+    std::vector<VmaAllocation> m_deferredFrees;
 
     void createAllocator(const vk::PhysicalDevice& physicalDevice, const vk::Device& device);
+    void reportLeaks();
 };
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace SEngine {
+class RenderGraph;
+
+//pipelines that differ only in boolean specialization constants. a variant is a bit mask where bit N
+//sets the constant with constant_id N, so shaders can drop features a variant doesn't need instead of branching on them.
+//variants are built on a worker thread, so asking for a new one never stalls the frame
+class PipelineVariants {
+public:
+    using Builder = std::function<std::unique_ptr<vk::raii::Pipeline>(const vk::SpecializationInfo& specialization)>;
+
+    PipelineVariants(RenderGraph& graph, uint32_t constantCount, Builder builder);
+    PipelineVariants(const PipelineVariants& other) = delete;
+    PipelineVariants& operator = (const PipelineVariants& other) = delete;
+    PipelineVariants(PipelineVariants&& other) = delete;
+    PipelineVariants& operator = (PipelineVariants&& other) = delete;
+    ~PipelineVariants();
+
+    //returns nullptr and queues the variant on the worker if it isn't built yet
+    vk::raii::Pipeline* tryGet(uint32_t variant);
+    //builds the variant on the calling thread if it isn't built yet
+    vk::raii::Pipeline& get(uint32_t variant);
+
+    //waits for the worker, then retires every variant through the render graph. call this before
+    //changing anything the builder reads, such as the render pass
+    void clear();
+
+private:
+    RenderGraph* m_graph;
+    uint32_t m_constantCount;
+    Builder m_builder;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workCondition;
+    std::condition_variable m_idleCondition;
+    std::thread m_worker;
+    bool m_stop;
+    bool m_building;
+    uint32_t m_buildingVariant;
+    std::exception_ptr m_error;
+
+    std::unordered_map<uint32_t, std::unique_ptr<vk::raii::Pipeline>> m_pipelines;
+    std::deque<uint32_t> m_queue;
+
+    std::unique_ptr<vk::raii::Pipeline> build(uint32_t variant);
+    void work();
+};
+}
@@ -17,10 +17,11 @@ namespace SEngine {
         void preRender(uint32_t currentFrame);
         void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {}
         void postRender(uint32_t currentFrame) {}
+        bool isDirty() const { return false; }
 
     private:
         vk::raii::SwapchainKHR* m_swapchain;
-        std::unique_ptr<vk::raii::Semaphore> m_semaphore;
+        std::vector<vk::raii::Semaphore> m_semaphores;
         std::unique_ptr<RenderGraph::ImageUsage> m_imageUsage;
         uint32_t m_swapchainIndex;
 
@@ -0,0 +1,58 @@
+#pragma once
+#include "SimpleEngine/RenderGraph/RenderGraph.h"
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vk_mem_alloc.h>
+
+namespace SEngine {
+class Engine;
+class Graphics;
+class TransferNode;
+
+//moves buffers in small steps: the copies run in one frame, the buffers are relocated once that frame finishes
+//and the old memory is released once no frame in flight can still use the old handles.
+//the pass never blocks, memory allocated or freed while it is open is handled by MemoryManager
+class DefragmentNode : public RenderGraph::Node {
+public:
+    DefragmentNode(Engine& engine, RenderGraph& graph, TransferNode& transferNode, vk::DeviceSize bytesPerFrame, uint32_t frameInterval);
+    ~DefragmentNode();
+
+    //connect from the transfer node, so this frame's uploads land before the copies read them
+    RenderGraph::BufferUsage& bufferUsage() const { return *m_bufferUsage; }
+
+    void preRender(uint32_t currentFrame);
+    void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
+    void postRender(uint32_t currentFrame) {}
+    bool isDirty() const { return m_state != State::Idle; }
+
+private:
+    enum class State {
+        Idle,
+        Copying,
+        Relocated
+    };
+
+    Engine* m_engine;
+    Graphics* m_graphics;
+    TransferNode* m_transferNode;
+    std::unique_ptr<RenderGraph::BufferUsage> m_bufferUsage;
+    vk::DeviceSize m_bytesPerFrame;
+    uint32_t m_frameInterval;
+    uint32_t m_frameCounter;
+    uint32_t m_settledAllocationCount;
+    vk::DeviceSize m_settledUsedBytes;
+    bool m_defragmentDue;
+
+    State m_state;
+    uint32_t m_stateFrame;  //frame count the copies were submitted in, or the first frame using the new handles
+    VmaDefragmentationContext m_context;
+    std::vector<VmaAllocation> m_allocations;
+    std::vector<VkBool32> m_changed;
+
+    bool isFragmented();
+    void beginPass(vk::raii::CommandBuffer& commandBuffer);
+    void relocateBuffers();
+    void endPass();
+};
+}
@@ -15,11 +15,12 @@ public:
     void preRender(uint32_t currentFrame) {}
     void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {}
     void postRender(uint32_t currentFrame);
+    bool isDirty() const { return false; }
 
 private:
     const vk::raii::Queue* m_presentQueue;
     AcquireNode* m_acquireNode;
-    std::unique_ptr<vk::raii::Semaphore> m_semaphore;
+    std::vector<vk::raii::Semaphore> m_semaphores;
     std::unique_ptr<RenderGraph::ImageUsage> m_imageUsage;
 };
 }
\ No newline at end of file
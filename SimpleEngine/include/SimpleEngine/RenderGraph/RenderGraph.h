@@ -56,9 +56,18 @@ namespace SEngine {
             void clear(uint32_t currentFrame);
         };
 
+        //how a node should load and store a color attachment, derived from the graph in bake()
+        struct AttachmentInfo {
+            vk::AttachmentLoadOp loadOp = vk::AttachmentLoadOp::eClear;
+            vk::AttachmentStoreOp storeOp = vk::AttachmentStoreOp::eStore;
+            vk::ImageLayout initialLayout = vk::ImageLayout::eUndefined;
+            vk::ImageLayout finalLayout = vk::ImageLayout::ePresentSrcKHR;
+        };
+
         class ImageUsage {
             friend class Node;
             friend class ImageEdge;
+            friend class RenderGraph;
         public:
             ImageUsage(Node& node, vk::ImageLayout imageLayout, vk::AccessFlagBits accessMask, vk::PipelineStageFlagBits stageFlags);
 
@@ -66,6 +75,8 @@ namespace SEngine {
             vk::ImageLayout imageLayout() const { return m_imageLayout; }
             vk::AccessFlagBits accessMask() const { return m_accessMask; }
             vk::PipelineStageFlagBits stageFlags() const { return m_stageFlags; }
+            bool isAttachment() const { return m_imageLayout == vk::ImageLayout::eColorAttachmentOptimal; }
+            const AttachmentInfo& attachmentInfo() const { return m_attachmentInfo; }
 
             void sync(Image& image, vk::ImageSubresourceRange subresource);
 
@@ -75,6 +86,7 @@ namespace SEngine {
             vk::AccessFlagBits m_accessMask;
             vk::PipelineStageFlagBits m_stageFlags;
             std::vector<std::unordered_map<const vk::Image*, std::vector<ImageSegment>>> m_images;
+            AttachmentInfo m_attachmentInfo;
 
             std::unordered_map<const vk::Image*, std::vector<ImageSegment>>& getSyncs(uint32_t currentFrame) { return m_images[currentFrame]; }
 
@@ -120,6 +132,9 @@ namespace SEngine {
             friend class RenderGraph;
         public:
             ImageEdge(ImageUsage& sourceUsage, ImageUsage& destUsage);
+
+            ImageUsage& sourceUsage() const { return *m_sourceUsage; }
+            ImageUsage& destUsage() const { return *m_destUsage; }
             vk::PipelineStageFlagBits sourceStage() const;
             vk::PipelineStageFlagBits destStage() const;
 
@@ -148,15 +163,32 @@ namespace SEngine {
             void addExternalWait(vk::raii::Semaphore& semaphore, vk::PipelineStageFlagBits stages);
             void addExternalSignal(vk::raii::Semaphore& semaphore);
 
+            //one semaphore per frame in flight, the one for the current frame is used on each submit
+            void addExternalWait(std::vector<vk::raii::Semaphore>& semaphores, vk::PipelineStageFlagBits stages);
+            void addExternalSignal(std::vector<vk::raii::Semaphore>& semaphores);
+
             virtual void preRender(uint32_t currentFrame) = 0;
             virtual void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) = 0;
             virtual void postRender(uint32_t currentFrame) = 0;
 
+            //called at the end of RenderGraph::bake, once attachment info is known
+            virtual void onBake() {}
+
+            //false when the node has nothing new to draw, letting the engine skip the frame in render on demand mode
+            virtual bool isDirty() const { return true; }
+
         protected:
             vk::raii::CommandPool& commandPool() const { return *m_commandPool; }
 
         private:
+            struct FrameSemaphores {
+                size_t index;
+                std::vector<vk::Semaphore> semaphores;
+            };
+
             struct SubmitInfo {
+                std::vector<FrameSemaphores> frameWaitSemaphores;
+                std::vector<FrameSemaphores> frameSignalSemaphores;
                 std::vector<vk::Semaphore> waitSemaphores;
                 std::vector<vk::PipelineStageFlags> waitDstStageMask;
                 std::vector<uint64_t> waitSemaphoreValues;
@@ -218,9 +250,19 @@ namespace SEngine {
 
         void execute();
 
+        //true when any node has something new to draw
+        bool isDirty() const;
+
         void queueDestroy(BufferState&& state);
         void queueDestroy(ImageState&& state);
 
+        //keeps any object alive until the frames that may still be using it have finished
+        template<class T>
+        void queueDestroy(std::unique_ptr<T>&& object) {
+            if (object == nullptr) return;
+            m_objectDestroyQueue.back().emplace_back(std::move(object));
+        }
+
     private:
         struct SemaphoreWaitInfo {
             std::vector<vk::Semaphore> semaphores;
@@ -234,13 +276,16 @@ namespace SEngine {
         bool m_baked;
         std::vector<std::unique_ptr<Node>> m_nodes;
         std::vector<std::unique_ptr<Edge>> m_edges;
+        std::vector<ImageEdge*> m_imageEdges;
         std::vector<Node*> m_nodeList;
         SemaphoreWaitInfo m_semaphoreWaitInfo;
 
         std::queue<std::vector<BufferState>> m_bufferDestroyQueue;
         std::queue<std::vector<ImageState>> m_imageDestroyQueue;
+        std::queue<std::vector<std::shared_ptr<void>>> m_objectDestroyQueue;
 
         void makeSemaphores();
+        void makeAttachmentInfo();
         void wait(uint32_t targetFrame);
     };
 }
\ No newline at end of file
@@ -15,11 +15,15 @@ public:
     void preRender(uint32_t currentFrame);
     void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
     void postRender(uint32_t currentFrame) {}
+    bool isDirty() const { return m_bufferCopies.size() > 0 || m_imageCopies.size() > 0; }
 
     void transfer(Buffer& buffer, vk::DeviceSize size, vk::DeviceSize offset, const void* data);
     void transfer(Image& image, vk::Offset3D offset, vk::Extent3D extent, vk::ImageSubresourceLayers subresourceLayers, const void* data);
     void transfer(Image& image, vk::Format format, std::vector<vk::BufferImageCopy>& copies, vk::Extent3D totalExtent, const void* data);
 
+    //true while a copy into the buffer is queued but not yet recorded
+    bool hasPendingTransfer(const Buffer& buffer) const;
+
 private:
     struct BufferInfo {
         const vk::Buffer* buffer;
@@ -8,4 +8,5 @@
 #include <SimpleEngine/Scene.h>
 #include <SimpleEngine/Clock.h>
 #include <SimpleEngine/ISystem.h>
-#include <SimpleEngine/Camera.h>
\ No newline at end of file
+#include <SimpleEngine/Camera.h>
+#include <SimpleEngine/ThreadPool.h>
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SEngine {
+class ThreadPool {
+public:
+    //threadCount 0 uses one worker per hardware thread, minus the calling thread
+    explicit ThreadPool(size_t threadCount = 0);
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator = (const ThreadPool& other) = delete;
+    ThreadPool(ThreadPool&& other) = delete;
+    ThreadPool& operator = (ThreadPool&& other) = delete;
+    ~ThreadPool();
+
+    size_t threadCount() const { return m_threads.size(); }
+
+    //calls job(i) for every i in [0, count) across the workers and the calling thread, returning once every call has finished.
+    //the first exception thrown by a job is rethrown here
+    void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stop;
+
+    void work();
+};
+}
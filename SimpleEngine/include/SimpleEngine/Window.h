@@ -20,7 +20,8 @@ public:
     GLFWwindow* handle() const { return m_window.get(); }
     Input& input() { return *m_input; }
 
-    void update();
+    //waitTimeout > 0 blocks until an event arrives or the timeout passes, in seconds
+    void update(double waitTimeout = 0);
 
     int32_t width() const { return m_width; }
     int32_t height() const { return m_height; }
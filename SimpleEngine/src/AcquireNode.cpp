@@ -11,9 +11,12 @@ AcquireNode::AcquireNode(Engine& engine, RenderGraph& graph)
     m_swapchain = engine.getGraphics().swapchain();
 
     vk::SemaphoreCreateInfo info = {};
-    m_semaphore = std::make_unique<vk::raii::Semaphore>(graph.device(), info);
 
-    addExternalWait(*m_semaphore, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+    for (uint32_t i = 0; i < graph.framesInFlight(); i++) {
+        m_semaphores.emplace_back(graph.device(), info);
+    }
+
+    addExternalWait(m_semaphores, vk::PipelineStageFlagBits::eColorAttachmentOutput);
 
     m_imageUsage = std::make_unique<RenderGraph::ImageUsage>(*this, vk::ImageLayout::eUndefined, vk::AccessFlagBits{}, vk::PipelineStageFlagBits::eBottomOfPipe);
 
@@ -21,7 +24,7 @@ AcquireNode::AcquireNode(Engine& engine, RenderGraph& graph)
 }
 
 void AcquireNode::preRender(uint32_t currentFrame) {
-    auto result = m_swapchain->acquireNextImage(std::numeric_limits<uint64_t>::max(), **m_semaphore, nullptr);
+    auto result = m_swapchain->acquireNextImage(std::numeric_limits<uint64_t>::max(), *m_semaphores[currentFrame], nullptr);
     m_swapchainIndex = std::get<1>(result);
 
     vk::Result resultVK = std::get<0>(result);
@@ -30,25 +30,68 @@ BufferState& BufferState::operator = (BufferState&& other) noexcept {
 }
 
 BufferState::~BufferState() {
-    vmaFreeMemory(engine->getGraphics().memory().allocator(), allocation);
+    if (allocation == VK_NULL_HANDLE) return;
+
+    MemoryManager& memory = engine->getGraphics().memory();
+    memory.untrackAllocation(allocation);
+    memory.freeAllocation(allocation);
 }
 
-Buffer::Buffer(Engine& engine, const vk::BufferCreateInfo& info, const VmaAllocationCreateInfo& allocInfo) {
+Buffer::Buffer(Engine& engine, const vk::BufferCreateInfo& info, const VmaAllocationCreateInfo& allocInfo, MemoryCategory category, const std::string& label)
+    : m_onRelocated(m_onRelocatedSignal) {
     m_engine = &engine;
+    m_info = info;
+    m_queueFamilyIndices = std::vector<uint32_t>(info.pQueueFamilyIndices, info.pQueueFamilyIndices + info.queueFamilyIndexCount);
+    m_info.pQueueFamilyIndices = m_queueFamilyIndices.data();
+
+    //persistently mapped buffers hand out raw pointers, so they must stay where they are
+    m_movable = (allocInfo.flags & VMA_ALLOCATION_CREATE_MAPPED_BIT) == 0;
 
-    VmaAllocator allocator = engine.getGraphics().memory().allocator();
+    MemoryManager& memory = engine.getGraphics().memory();
+    VmaAllocator allocator = memory.allocator();
+
+    VmaAllocationCreateInfo labeledAllocInfo = allocInfo;
+    if (!label.empty()) {
+        labeledAllocInfo.flags |= VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+        labeledAllocInfo.pUserData = const_cast<char*>(label.c_str());
+    }
+    memory.prepareAllocation(labeledAllocInfo);
 
     VkBuffer buffer;
     VmaAllocation allocation;
-    vmaCreateBuffer(allocator, &(VkBufferCreateInfo)info, &allocInfo, &buffer, &allocation, &m_allocationInfo);
+    vmaCreateBuffer(allocator, &(VkBufferCreateInfo)info, &labeledAllocInfo, &buffer, &allocation, &m_allocationInfo);
 
     m_bufferState = std::make_unique<BufferState>(m_engine, info.size, vk::raii::Buffer(engine.getGraphics().device(), buffer), allocation);
+    memory.trackAllocation(allocation, category, m_allocationInfo.size, label);
+
+    if (m_movable) {
+        memory.addMovableBuffer(*this);
+    }
 }
 
 Buffer::~Buffer() {
+    if (m_movable) {
+        m_engine->getGraphics().memory().removeMovableBuffer(*this);
+    }
+
     m_engine->getRenderGraph().queueDestroy(std::move(*m_bufferState));
 }
 
 void* Buffer::getMapping() const {
     return m_allocationInfo.pMappedData;
+}
+
+void Buffer::relocate() {
+    VmaAllocator allocator = m_engine->getGraphics().memory().allocator();
+
+    //the allocation was moved by the defragmenter, so bind a fresh handle to its new location
+    vk::raii::Buffer buffer(m_engine->getGraphics().device(), m_info);
+    vmaBindBufferMemory(allocator, m_bufferState->allocation, *buffer);
+
+    //frames still in flight may be using the old handle
+    m_engine->getRenderGraph().queueDestroy(std::make_unique<vk::raii::Buffer>(std::move(m_bufferState->buffer)));
+    m_bufferState->buffer = std::move(buffer);
+    vmaGetAllocationInfo(allocator, m_bufferState->allocation, &m_allocationInfo);
+
+    m_onRelocatedSignal.publish(*this);
 }
\ No newline at end of file
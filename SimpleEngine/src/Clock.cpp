@@ -13,6 +13,11 @@ void Clock::update(float currentTime) {
     m_time = currentTime;
 }
 
+void Clock::reset(float currentTime) {
+    m_delta = 0;
+    m_time = currentTime;
+}
+
 float Clock::currentTime() {
     return m_time;
 }
@@ -0,0 +1,169 @@
+#include "SimpleEngine/RenderGraph/DefragmentNode.h"
+#include "SimpleEngine/RenderGraph/TransferNode.h"
+#include "SimpleEngine/Engine.h"
+#include "SimpleEngine/Graphics.h"
+#include "SimpleEngine/Buffer.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace SEngine;
+
+DefragmentNode::DefragmentNode(Engine& engine, RenderGraph& graph, TransferNode& transferNode, vk::DeviceSize bytesPerFrame, uint32_t frameInterval)
+    : RenderGraph::Node(graph, engine.getGraphics().graphicsQueue()) {
+    m_engine = &engine;
+    m_graphics = &engine.getGraphics();
+    m_transferNode = &transferNode;
+    m_bufferUsage = std::make_unique<RenderGraph::BufferUsage>(*this, vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer);
+    m_bytesPerFrame = bytesPerFrame;
+    m_frameInterval = std::max<uint32_t>(frameInterval, 1);
+    m_frameCounter = 0;
+    m_settledAllocationCount = 0;
+    m_settledUsedBytes = 0;
+    m_defragmentDue = false;
+    m_state = State::Idle;
+    m_stateFrame = 0;
+    m_context = VK_NULL_HANDLE;
+}
+
+DefragmentNode::~DefragmentNode() {
+    if (m_state == State::Idle) return;
+
+    m_graphics->device().waitIdle();
+    endPass();
+}
+
+void DefragmentNode::preRender(uint32_t currentFrame) {
+    //the graph waits on this frame count before preRender
+    uint32_t finishedFrame = graph().frameCount() - graph().framesInFlight();
+
+    if (m_state == State::Copying && finishedFrame >= m_stateFrame) {
+        relocateBuffers();
+    }
+
+    //frames before the relocation may still read the old locations
+    if (m_state == State::Relocated && finishedFrame + 1 >= m_stateFrame) {
+        endPass();
+    }
+
+    m_defragmentDue = false;
+    if (m_state != State::Idle) return;
+
+    m_frameCounter++;
+    if (m_frameCounter < m_frameInterval) return;
+    m_frameCounter = 0;
+
+    m_defragmentDue = isFragmented();
+}
+
+void DefragmentNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer) {
+    if (!m_defragmentDue) return;
+    m_defragmentDue = false;
+
+    beginPass(commandBuffer);
+}
+
+bool DefragmentNode::isFragmented() {
+    VmaStats stats = {};
+    vmaCalculateStats(m_graphics->memory().allocator(), &stats);
+
+    //a previous pass could not improve this layout, wait until allocations change
+    if (stats.total.allocationCount == m_settledAllocationCount && stats.total.usedBytes == m_settledUsedBytes) {
+        return false;
+    }
+
+    //a compact block has at most one free range at its end
+    return stats.total.unusedRangeCount > stats.total.blockCount;
+}
+
+void DefragmentNode::beginPass(vk::raii::CommandBuffer& commandBuffer) {
+    m_allocations.clear();
+
+    for (auto& pair : m_graphics->memory().movableBuffers()) {
+        //a copy queued after the transfer node recorded this frame would write the old location
+        if (m_transferNode->hasPendingTransfer(*pair.second)) continue;
+
+        m_allocations.push_back(pair.first);
+    }
+
+    if (m_allocations.size() == 0) return;
+
+    m_changed.assign(m_allocations.size(), VK_FALSE);
+
+    //earlier submits on this queue may still write the buffers being copied
+    vk::MemoryBarrier barrier = {};
+    barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {},
+        { barrier },
+        nullptr,
+        nullptr
+    );
+
+    VmaDefragmentationInfo2 info = {};
+    info.allocationCount = static_cast<uint32_t>(m_allocations.size());
+    info.pAllocations = m_allocations.data();
+    info.pAllocationsChanged = m_changed.data();
+    info.maxCpuBytesToMove = 0;
+    info.maxCpuAllocationsToMove = 0;
+    info.maxGpuBytesToMove = m_bytesPerFrame;
+    info.maxGpuAllocationsToMove = std::numeric_limits<uint32_t>::max();
+    info.commandBuffer = *commandBuffer;
+
+    VmaDefragmentationStats defragStats = {};
+    vmaDefragmentationBegin(m_graphics->memory().allocator(), &info, &defragStats, &m_context);
+
+    if (defragStats.allocationsMoved == 0) {
+        vmaDefragmentationEnd(m_graphics->memory().allocator(), m_context);
+        m_context = VK_NULL_HANDLE;
+
+        VmaStats stats = {};
+        vmaCalculateStats(m_graphics->memory().allocator(), &stats);
+        m_settledAllocationCount = stats.total.allocationCount;
+        m_settledUsedBytes = stats.total.usedBytes;
+        return;
+    }
+
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {},
+        { barrier },
+        nullptr,
+        nullptr
+    );
+
+    //the allocations already point at their new locations, but the copies have not run yet
+    m_graphics->memory().beginDefragmentation();
+    m_state = State::Copying;
+    m_stateFrame = graph().frameCount();
+}
+
+void DefragmentNode::relocateBuffers() {
+    auto& movableBuffers = m_graphics->memory().movableBuffers();
+
+    for (size_t i = 0; i < m_allocations.size(); i++) {
+        if (!m_changed[i]) continue;
+
+        //the buffer may have been destroyed while its copy was in flight
+        auto it = movableBuffers.find(m_allocations[i]);
+        if (it == movableBuffers.end()) continue;
+
+        it->second->relocate();
+    }
+
+    m_state = State::Relocated;
+    m_stateFrame = graph().frameCount();
+}
+
+void DefragmentNode::endPass() {
+    //frees the old ranges and any blocks left empty
+    vmaDefragmentationEnd(m_graphics->memory().allocator(), m_context);
+    m_graphics->memory().endDefragmentation();
+    m_context = VK_NULL_HANDLE;
+    m_allocations.clear();
+    m_changed.clear();
+    m_state = State::Idle;
+}
+
@@ -9,6 +9,7 @@
 #include "SimpleEngine/Graphics.h"
 #include "SimpleEngine/Clock.h"
 #include "SimpleEngine/ISystem.h"
+#include "SimpleEngine/ThreadPool.h"
 
 using namespace SEngine;
 
@@ -26,12 +27,17 @@ Engine::Engine() {
     m_graphics = nullptr;
     m_renderGraph = nullptr;
     m_shouldExit = false;
+    m_renderOnDemand = false;
+    m_renderRequested = true;
+    m_idleTimeout = 0;
+    m_swapchainVersion = 0;
 
     glfwSetErrorCallback(&handleGLFWError);
 
     glfwInit();
 
     m_renderClock = std::make_unique<Clock>();
+    m_threadPool = std::make_unique<ThreadPool>();
 }
 
 Engine::~Engine() {
@@ -48,6 +54,11 @@ Window& Engine::getWindow() {
 
 void Engine::setGraphics(Graphics& graphics) {
     m_graphics = &graphics;
+    m_swapchainVersion = graphics.swapchainVersion();
+
+    if (m_renderGraph != nullptr) {
+        m_graphics->setRenderGraph(*m_renderGraph);
+    }
 }
 
 Graphics& Engine::getGraphics() {
@@ -56,6 +67,10 @@ Graphics& Engine::getGraphics() {
 
 void Engine::setRenderGraph(RenderGraph& renderGraph) {
     m_renderGraph = &renderGraph;
+
+    if (m_graphics != nullptr) {
+        m_graphics->setRenderGraph(renderGraph);
+    }
 }
 
 RenderGraph& Engine::getRenderGraph() {
@@ -66,6 +81,15 @@ void Engine::addSystem(ISystem& system) {
     m_renderSystems.push_back(&system);
 }
 
+void Engine::setRenderOnDemand(bool enabled, double idleTimeout) {
+    m_renderOnDemand = enabled;
+    m_idleTimeout = idleTimeout;
+}
+
+void Engine::requestRender() {
+    m_renderRequested = true;
+}
+
 void Engine::run() {
     if (m_window == nullptr) throw std::runtime_error("Window not set");
     if (m_graphics == nullptr) throw std::runtime_error("Graphics context not set");
@@ -76,22 +100,47 @@ void Engine::run() {
         return a->getPriority() < b->getPriority();
     });
 
+    bool idle = false;
+
     while (true) {
-        m_window->update();
+        m_window->update(idle ? m_idleTimeout : 0);
 
         if (m_window->shouldClose()) {
             break;
         }
 
-        m_renderClock->update(static_cast<float>(glfwGetTime()));
+        if (idle) {
+            m_renderClock->reset(static_cast<float>(glfwGetTime()));
+        } else {
+            m_renderClock->update(static_cast<float>(glfwGetTime()));
+        }
+
+        //the swapchain is polled instead of subscribed to, so the engine holds no connection into a Graphics it does not own.
+        //new swapchain images have never been drawn to
+        if (m_graphics->swapchainVersion() != m_swapchainVersion) {
+            m_swapchainVersion = m_graphics->swapchainVersion();
+            m_renderRequested = true;
+        }
+
+        bool dirty = !m_renderOnDemand || m_renderRequested;
 
         for (auto system : m_renderSystems) {
             system->update(*m_renderClock);
+            dirty |= system->isDirty();
         }
 
+        dirty = dirty || m_renderGraph->isDirty();
+        idle = !dirty;
+
+        if (!dirty) continue;
+
+        m_renderRequested = false;
+
         if (m_graphics->swapchain() != nullptr) {
             m_renderGraph->execute();
         }
+
+        m_graphics->memory().newFrame();
     }
 
     m_graphics->device().waitIdle();
@@ -1,10 +1,13 @@
 #include "SimpleEngine/Graphics.h"
 
 #include <iostream>
+#include <fstream>
+#include <cstring>
 #include <unordered_set>
 #include <GLFW/glfw3.h>
 
 #include "SimpleEngine/Window.h"
+#include "SimpleEngine/RenderGraph/RenderGraph.h"
 
 const std::vector<const char*> deviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME
@@ -12,13 +15,33 @@ const std::vector<const char*> deviceExtensions = {
 
 using namespace SEngine;
 
+//written in front of the driver's cache data, so a cache from another device or driver is discarded
+struct PipelineCacheHeader {
+    uint32_t magic;
+    uint32_t dataSize;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+const uint32_t pipelineCacheMagic = 0x50434853;
+
 bool Graphics::QueueFamilies::valid() const {
     return graphics.has_value() && present.has_value() && transfer.has_value();
 }
 
-Graphics::Graphics(Window& window, const std::string& appName)
+Graphics::Graphics(Window& window, const std::string& appName, const SwapchainSettings& swapchainSettings)
     : m_onSwapchainChanged(m_onSwapchainChangedSignal) {
     m_window = &window;
+    m_swapchainSettings = swapchainSettings;
+    m_renderGraph = nullptr;
+    m_presentMode = vk::PresentModeKHR::eFifo;
+    m_dynamicRendering = false;
+    m_swapchainVersion = 0;
+    m_drawIndirectCount = false;
+    m_multiDrawIndirect = false;
+    m_drawIndirectFirstInstance = false;
 
     createInstance(appName);
     createSurface();
@@ -28,9 +51,26 @@ Graphics::Graphics(Window& window, const std::string& appName)
 
     m_memoryManager = std::make_unique<MemoryManager>(**m_physicalDevice, **m_device);
 
+    m_pipelineCachePath = "pipeline_cache.bin";
+    createPipelineCache();
+
     m_framebufferConnection = window.onFramebufferResized().connect<&Graphics::recreateSwapchain>(this);
 }
 
+Graphics::~Graphics() {
+    if (m_pipelineCache == nullptr) return;
+
+    try {
+        savePipelineCache();
+    } catch (std::exception& ex) {
+        std::cout << "Failed to save pipeline cache: " << ex.what() << "\n";
+    }
+}
+
+void Graphics::setRenderGraph(RenderGraph& renderGraph) {
+    m_renderGraph = &renderGraph;
+}
+
 void Graphics::createInstance(const std::string& appName) {
     m_context = std::make_unique<vk::raii::Context>();
 
@@ -167,16 +207,57 @@ void Graphics::createDevice(vk::raii::PhysicalDevice& physicalDevice, QueueFamil
         queueInfos.push_back(queueInfo);
     }
 
+    std::vector<const char*> extensions = deviceExtensions;
+
     vk::PhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {};
     timelineSemaphoreFeatures.timelineSemaphore = true;
 
     vk::PhysicalDeviceFeatures2 features = {};
     features.pNext = &timelineSemaphoreFeatures;
 
+    //optional, indirect draws fall back to one command per slot without multiDrawIndirect,
+    //and to host side draws without drawIndirectFirstInstance
+    vk::PhysicalDeviceFeatures supportedFeatures = m_physicalDevice->getFeatures();
+    m_multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    m_drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    features.features.multiDrawIndirect = m_multiDrawIndirect;
+    features.features.drawIndirectFirstInstance = m_drawIndirectFirstInstance;
+
+#ifdef VK_KHR_draw_indirect_count
+    //optional, without it the GPU written draw count is ignored and every slot is drawn
+    for (auto& extension : m_physicalDevice->enumerateDeviceExtensionProperties()) {
+        if (std::string(extension.extensionName.data()) == VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) {
+            m_drawIndirectCount = true;
+        }
+    }
+
+    if (m_drawIndirectCount) {
+        extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+#endif
+
+#ifdef VK_KHR_dynamic_rendering
+    //optional, nodes fall back to render passes and framebuffers when it is missing
+    vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+    dynamicRenderingFeatures.dynamicRendering = true;
+
+    for (auto& extension : m_physicalDevice->enumerateDeviceExtensionProperties()) {
+        if (std::string(extension.extensionName.data()) == VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) {
+            auto supported = m_physicalDevice->getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+            m_dynamicRendering = supported.get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>().dynamicRendering;
+        }
+    }
+
+    if (m_dynamicRendering) {
+        extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        timelineSemaphoreFeatures.pNext = &dynamicRenderingFeatures;
+    }
+#endif
+
     vk::DeviceCreateInfo info = {};
     info.pNext = &features;
-    info.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    info.ppEnabledExtensionNames = deviceExtensions.data();
+    info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    info.ppEnabledExtensionNames = extensions.data();
     info.queueCreateInfoCount = static_cast<uint32_t>(queueInfos.size());
     info.pQueueCreateInfos = queueInfos.data();
 
@@ -187,6 +268,65 @@ void Graphics::createDevice(vk::raii::PhysicalDevice& physicalDevice, QueueFamil
     m_transferQueue = std::make_unique<QueueInfo>(*m_device, *queueFamilies.transfer);
 }
 
+void Graphics::createPipelineCache() {
+    vk::PhysicalDeviceProperties properties = m_physicalDevice->getProperties();
+    std::vector<char> data;
+    std::ifstream file(m_pipelineCachePath, std::ios::binary);
+
+    if (file.is_open()) {
+        PipelineCacheHeader header = {};
+        file.read(reinterpret_cast<char*>(&header), sizeof(PipelineCacheHeader));
+
+        bool valid = file.good()
+            && header.magic == pipelineCacheMagic
+            && header.vendorID == properties.vendorID
+            && header.deviceID == properties.deviceID
+            && header.driverVersion == properties.driverVersion
+            && memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+
+        if (valid) {
+            data.resize(header.dataSize);
+            file.read(data.data(), data.size());
+
+            if (!file.good()) {
+                data.clear();
+            }
+        }
+
+        if (data.size() == 0) {
+            std::cout << "Pipeline cache is stale or corrupt, starting with an empty cache\n";
+        }
+    }
+
+    vk::PipelineCacheCreateInfo info = {};
+    info.initialDataSize = data.size();
+    info.pInitialData = data.data();
+
+    m_pipelineCache = std::make_unique<vk::raii::PipelineCache>(*m_device, info);
+}
+
+void Graphics::savePipelineCache() {
+    vk::PhysicalDeviceProperties properties = m_physicalDevice->getProperties();
+    std::vector<uint8_t> data = m_pipelineCache->getData();
+
+    PipelineCacheHeader header = {};
+    header.magic = pipelineCacheMagic;
+    header.dataSize = static_cast<uint32_t>(data.size());
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+    std::ofstream file(m_pipelineCachePath, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open pipeline cache file");
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(PipelineCacheHeader));
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
 vk::Format Graphics::chooseFormat(std::vector<vk::SurfaceFormatKHR>& formats) {
     for (const auto& format : formats) {
         if (format.format == vk::Format::eB8G8R8A8Srgb && format.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear) {
@@ -197,7 +337,16 @@ vk::Format Graphics::chooseFormat(std::vector<vk::SurfaceFormatKHR>& formats) {
     return formats[0].format;
 }
 
-vk::PresentModeKHR Graphics::choosePresentMode(std::vector<vk::PresentModeKHR>& mdoes) {
+vk::PresentModeKHR Graphics::choosePresentMode(std::vector<vk::PresentModeKHR>& modes) {
+    for (auto preferred : m_swapchainSettings.presentModes) {
+        for (auto mode : modes) {
+            if (mode == preferred) {
+                return mode;
+            }
+        }
+    }
+
+    //FIFO is always supported
     return vk::PresentModeKHR::eFifo;
 }
 
@@ -222,9 +371,20 @@ vk::Extent2D Graphics::chooseExtent(vk::SurfaceCapabilitiesKHR& capabilities) {
 }
 
 void Graphics::recreateSwapchain(int32_t width, int32_t height) {
-    m_device->waitIdle();
+    if (m_renderGraph == nullptr) {
+        m_device->waitIdle();
+    }
+
+    //views are retired before the swapchain that owns their images
+    if (m_renderGraph != nullptr) {
+        m_renderGraph->queueDestroy(std::make_unique<std::vector<vk::raii::ImageView>>(std::move(m_swapchainImageViews)));
+        m_swapchainImageViews.clear();
+    }
+
     createSwapchain();
     createImageViews();
+    m_swapchainVersion++;
+
     m_onSwapchainChangedSignal.publish(m_swapchain.get());
 }
 
@@ -233,9 +393,12 @@ void Graphics::createSwapchain() {
     auto presentModes = m_physicalDevice->getSurfacePresentModesKHR(**m_surface);
     auto capabilities = m_physicalDevice->getSurfaceCapabilitiesKHR(**m_surface);
 
+    //the old swapchain may still have frames in flight, so it is retired instead of destroyed
+    std::unique_ptr<vk::raii::SwapchainKHR> oldSwapchain = std::move(m_swapchain);
+
     if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0) {
         //cannot create a swapchain
-        m_swapchain = nullptr;
+        retireSwapchain(std::move(oldSwapchain));
         m_swapchainFormat = vk::Format::eUndefined;
         m_swapchainExtent = vk::Extent2D{};
         return;
@@ -245,7 +408,8 @@ void Graphics::createSwapchain() {
     auto presentMode = choosePresentMode(presentModes);
     m_swapchainExtent = chooseExtent(capabilities);
     uint32_t max = capabilities.maxImageCount > 0 ? capabilities.maxImageCount : std::numeric_limits<uint32_t>::max();
-    uint32_t imageCount = std::clamp<uint32_t>(2, capabilities.minImageCount, max);
+    uint32_t imageCount = std::clamp<uint32_t>(m_swapchainSettings.imageCount, capabilities.minImageCount, max);
+    m_presentMode = presentMode;
 
     vk::SwapchainCreateInfoKHR info = {};
     info.surface = **m_surface;
@@ -256,6 +420,13 @@ void Graphics::createSwapchain() {
     info.imageArrayLayers = 1;
     info.imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
 
+    //lets nodes copy or blit into the swapchain, such as an upscale from a smaller render target
+    if (capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst) {
+        info.imageUsage |= vk::ImageUsageFlagBits::eTransferDst;
+    }
+
+    m_swapchainUsage = info.imageUsage;
+
     uint32_t indices[] = { m_graphicsQueue->familyIndex,  m_presentQueue->familyIndex };
     if (m_graphicsQueue->familyIndex == m_presentQueue->familyIndex) {
         info.imageSharingMode = vk::SharingMode::eExclusive;
@@ -268,9 +439,10 @@ void Graphics::createSwapchain() {
     info.preTransform = capabilities.currentTransform;
     info.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
     info.clipped = true;
-    info.oldSwapchain = m_swapchain != nullptr ? **m_swapchain : VK_NULL_HANDLE;
+    info.oldSwapchain = oldSwapchain != nullptr ? **oldSwapchain : VK_NULL_HANDLE;
 
     m_swapchain = std::make_unique<vk::raii::SwapchainKHR>(*m_device, info);
+    retireSwapchain(std::move(oldSwapchain));
 
     auto images = m_swapchain->getImages();
     m_swapchainImages.clear();
@@ -280,6 +452,14 @@ void Graphics::createSwapchain() {
     }
 }
 
+void Graphics::retireSwapchain(std::unique_ptr<vk::raii::SwapchainKHR>&& swapchain) {
+    if (m_renderGraph != nullptr) {
+        m_renderGraph->queueDestroy(std::move(swapchain));
+    } else {
+        swapchain.reset();
+    }
+}
+
 void Graphics::createImageViews() {
     m_swapchainImageViews.clear();
 
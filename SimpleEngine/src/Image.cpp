@@ -32,21 +32,34 @@ ImageState& ImageState::operator = (ImageState&& other) noexcept {
 }
 
 ImageState::~ImageState() {
-    vmaFreeMemory(engine->getGraphics().memory().allocator(), allocation);
+    if (allocation == VK_NULL_HANDLE) return;
+
+    MemoryManager& memory = engine->getGraphics().memory();
+    memory.untrackAllocation(allocation);
+    memory.freeAllocation(allocation);
 }
 
-Image::Image(Engine& engine, const vk::ImageCreateInfo& info, const VmaAllocationCreateInfo& allocInfo) {
+Image::Image(Engine& engine, const vk::ImageCreateInfo& info, const VmaAllocationCreateInfo& allocInfo, MemoryCategory category, const std::string& label) {
     m_engine = &engine;
 
-    VmaAllocator allocator = engine.getGraphics().memory().allocator();
+    MemoryManager& memory = engine.getGraphics().memory();
+    VmaAllocator allocator = memory.allocator();
+
+    VmaAllocationCreateInfo labeledAllocInfo = allocInfo;
+    if (!label.empty()) {
+        labeledAllocInfo.flags |= VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+        labeledAllocInfo.pUserData = const_cast<char*>(label.c_str());
+    }
+    memory.prepareAllocation(labeledAllocInfo);
 
     VkImage buffer;
     VmaAllocation allocation;
     VmaAllocationInfo allocationInfo;
-    vmaCreateImage(allocator, &(VkImageCreateInfo)info, &allocInfo, &buffer, &allocation, &allocationInfo);
+    vmaCreateImage(allocator, &(VkImageCreateInfo)info, &labeledAllocInfo, &buffer, &allocation, &allocationInfo);
 
     m_imageState = std::make_unique<ImageState>(m_engine, info, vk::raii::Image(engine.getGraphics().device(), buffer), allocation);
     m_allocationInfo = allocationInfo;
+    memory.trackAllocation(allocation, category, allocationInfo.size, label);
 }
 
 Image::~Image() {
@@ -1,12 +1,23 @@
 #include "SimpleEngine/MemoryManager.h"
+#include "SimpleEngine/Buffer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
 
 using namespace SEngine;
 
 MemoryManager::MemoryManager(const vk::PhysicalDevice& physicalDevice, const vk::Device& device) {
+    m_stats = {};
+    m_defragmenting = false;
+    m_frameCounts = {};
+
     createAllocator(physicalDevice, device);
 }
 
 MemoryManager::~MemoryManager() {
+    endDefragmentation();
+    reportLeaks();
     vmaDestroyAllocator(m_allocator);
 }
 
@@ -16,4 +27,128 @@ void MemoryManager::createAllocator(const vk::PhysicalDevice& physicalDevice, co
     info.device = device;
 
     vmaCreateAllocator(&info, &m_allocator);
+}
+
+void MemoryManager::beginDefragmentation() {
+    m_defragmenting = true;
+}
+
+void MemoryManager::endDefragmentation() {
+    m_defragmenting = false;
+
+    for (auto allocation : m_deferredFrees) {
+        vmaFreeMemory(m_allocator, allocation);
+    }
+
+    m_deferredFrees.clear();
+}
+
+void MemoryManager::prepareAllocation(VmaAllocationCreateInfo& info) const {
+    //dedicated memory stays out of the block vectors being defragmented
+    if (m_defragmenting) {
+        info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
+}
+
+void MemoryManager::freeAllocation(VmaAllocation allocation) {
+    if (m_defragmenting) {
+        m_deferredFrees.push_back(allocation);
+    } else {
+        vmaFreeMemory(m_allocator, allocation);
+    }
+}
+
+void MemoryManager::addMovableBuffer(Buffer& buffer) {
+    m_movableBuffers.insert({ buffer.allocation(), &buffer });
+}
+
+void MemoryManager::removeMovableBuffer(Buffer& buffer) {
+    m_movableBuffers.erase(buffer.allocation());
+}
+
+void MemoryManager::trackAllocation(VmaAllocation allocation, MemoryCategory category, vk::DeviceSize size, const std::string& label) {
+    m_allocations.insert({ allocation, { category, size, label } });
+
+    size_t index = static_cast<size_t>(category);
+    MemoryStats& stats = m_stats[index];
+    stats.allocationCount++;
+    stats.usedBytes += size;
+    stats.peakBytes = std::max(stats.peakBytes, stats.usedBytes);
+    m_frameCounts[index].allocations++;
+}
+
+void MemoryManager::untrackAllocation(VmaAllocation allocation) {
+    auto it = m_allocations.find(allocation);
+    if (it == m_allocations.end()) return;
+
+    size_t index = static_cast<size_t>(it->second.category);
+    MemoryStats& stats = m_stats[index];
+    stats.allocationCount--;
+    stats.usedBytes -= it->second.size;
+    m_frameCounts[index].frees++;
+
+    m_allocations.erase(it);
+}
+
+void MemoryManager::newFrame() {
+    for (size_t i = 0; i < m_stats.size(); i++) {
+        m_stats[i].frameAllocations = m_frameCounts[i].allocations;
+        m_stats[i].frameFrees = m_frameCounts[i].frees;
+        m_frameCounts[i] = {};
+    }
+}
+
+std::string MemoryManager::buildStatsString(bool detailedMap) const {
+    char* vmaString;
+    vmaBuildStatsString(m_allocator, &vmaString, detailedMap);
+    std::string result = vmaString;
+    vmaFreeStatsString(m_allocator, vmaString);
+
+    std::stringstream stream;
+    stream << ", \"Categories\": {";
+
+    for (size_t i = 0; i < m_stats.size(); i++) {
+        const MemoryStats& stats = m_stats[i];
+
+        if (i > 0) stream << ", ";
+        stream << "\"" << categoryName(static_cast<MemoryCategory>(i)) << "\": {"
+            << "\"AllocationCount\": " << stats.allocationCount << ", "
+            << "\"FrameAllocations\": " << stats.frameAllocations << ", "
+            << "\"FrameFrees\": " << stats.frameFrees << ", "
+            << "\"UsedBytes\": " << stats.usedBytes << ", "
+            << "\"PeakBytes\": " << stats.peakBytes << "}";
+    }
+
+    stream << "}";
+
+    //append the category table to the root object written by VMA
+    size_t end = result.find_last_of('}');
+    if (end != std::string::npos) {
+        result.insert(end, stream.str());
+    }
+
+    return result;
+}
+
+const char* MemoryManager::categoryName(MemoryCategory category) {
+    switch (category) {
+    default: return "Other";
+    case MemoryCategory::Staging: return "Staging";
+    case MemoryCategory::Vertex: return "Vertex";
+    case MemoryCategory::Uniform: return "Uniform";
+    case MemoryCategory::Texture: return "Texture";
+    }
+}
+
+void MemoryManager::reportLeaks() {
+    if (m_allocations.size() == 0) return;
+
+    std::cout << "Memory leak: " << m_allocations.size() << " allocations were never freed\n";
+
+    for (auto& pair : m_allocations) {
+        auto& record = pair.second;
+        std::cout << "    [" << categoryName(record.category) << "] "
+            << (record.label.empty() ? "(unlabeled)" : record.label)
+            << " (" << record.size << " bytes)\n";
+    }
 }
\ No newline at end of file
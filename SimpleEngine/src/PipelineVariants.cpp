@@ -0,0 +1,137 @@
+#include "SimpleEngine/PipelineVariants.h"
+#include "SimpleEngine/RenderGraph/RenderGraph.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+using namespace SEngine;
+
+PipelineVariants::PipelineVariants(RenderGraph& graph, uint32_t constantCount, Builder builder) {
+    if (constantCount > 32) throw std::runtime_error("Too many specialization constants (max 32)");
+
+    m_graph = &graph;
+    m_constantCount = constantCount;
+    m_builder = std::move(builder);
+    m_stop = false;
+    m_building = false;
+    m_buildingVariant = 0;
+
+    m_worker = std::thread(&PipelineVariants::work, this);
+}
+
+PipelineVariants::~PipelineVariants() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_workCondition.notify_all();
+    m_worker.join();
+}
+
+vk::raii::Pipeline* PipelineVariants::tryGet(uint32_t variant) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_error) std::rethrow_exception(m_error);
+
+    auto it = m_pipelines.find(variant);
+    if (it != m_pipelines.end()) return it->second.get();
+
+    bool building = m_building && m_buildingVariant == variant;
+    bool queued = std::find(m_queue.begin(), m_queue.end(), variant) != m_queue.end();
+
+    if (!building && !queued) {
+        m_queue.push_back(variant);
+        m_workCondition.notify_one();
+    }
+
+    return nullptr;
+}
+
+vk::raii::Pipeline& PipelineVariants::get(uint32_t variant) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    //the worker may already be building this variant, waiting is cheaper than building it twice
+    m_idleCondition.wait(lock, [&] { return !m_building || m_buildingVariant != variant; });
+
+    if (m_error) std::rethrow_exception(m_error);
+
+    auto it = m_pipelines.find(variant);
+    if (it != m_pipelines.end()) return *it->second;
+
+    m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), variant), m_queue.end());
+    lock.unlock();
+
+    auto pipeline = build(variant);
+
+    lock.lock();
+    auto& result = m_pipelines[variant];
+    result = std::move(pipeline);
+
+    return *result;
+}
+
+void PipelineVariants::clear() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [&] { return !m_building; });
+
+    for (auto& pair : m_pipelines) {
+        m_graph->queueDestroy(std::move(pair.second));
+    }
+
+    m_pipelines.clear();
+    m_queue.clear();
+}
+
+std::unique_ptr<vk::raii::Pipeline> PipelineVariants::build(uint32_t variant) {
+    std::array<vk::SpecializationMapEntry, 32> entries = {};
+    std::array<vk::Bool32, 32> values = {};
+
+    for (uint32_t i = 0; i < m_constantCount; i++) {
+        entries[i].constantID = i;
+        entries[i].offset = i * sizeof(vk::Bool32);
+        entries[i].size = sizeof(vk::Bool32);
+        values[i] = (variant >> i) & 1;
+    }
+
+    vk::SpecializationInfo info = {};
+    info.mapEntryCount = m_constantCount;
+    info.pMapEntries = entries.data();
+    info.dataSize = m_constantCount * sizeof(vk::Bool32);
+    info.pData = values.data();
+
+    return m_builder(info);
+}
+
+void PipelineVariants::work() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_workCondition.wait(lock, [&] { return m_stop || m_queue.size() > 0; });
+        if (m_stop) return;
+
+        uint32_t variant = m_queue.front();
+        m_queue.pop_front();
+        m_building = true;
+        m_buildingVariant = variant;
+        lock.unlock();
+
+        std::unique_ptr<vk::raii::Pipeline> pipeline;
+
+        try {
+            pipeline = build(variant);
+        } catch (...) {
+            //rethrown on the render thread by the next tryGet or get
+            lock.lock();
+            m_error = std::current_exception();
+            m_building = false;
+            m_idleCondition.notify_all();
+            continue;
+        }
+
+        lock.lock();
+        m_pipelines[variant] = std::move(pipeline);
+        m_building = false;
+        m_idleCondition.notify_all();
+    }
+}
@@ -10,12 +10,15 @@ PresentNode::PresentNode(Engine& engine, RenderGraph& graph, vk::PipelineStageFl
     m_acquireNode = &acquireNode;
 
     vk::SemaphoreCreateInfo info = {};
-    m_semaphore = std::make_unique<vk::raii::Semaphore>(graph.device(), info);
+
+    for (uint32_t i = 0; i < graph.framesInFlight(); i++) {
+        m_semaphores.emplace_back(graph.device(), info);
+    }
 
     //Dummy ImageUsage. Used to set up semaphore. This should not have any images submitted to it.
     m_imageUsage = std::make_unique<RenderGraph::ImageUsage>(*this, vk::ImageLayout::ePresentSrcKHR, vk::AccessFlagBits{}, stage);
 
-    addExternalSignal(*m_semaphore);
+    addExternalSignal(m_semaphores);
 }
 
 void PresentNode::postRender(uint32_t currentFrame) {
@@ -26,7 +29,7 @@ void PresentNode::postRender(uint32_t currentFrame) {
     info.pSwapchains = &*m_acquireNode->swapchain();
     info.pImageIndices = &imageIndex;
     info.waitSemaphoreCount = 1;
-    info.pWaitSemaphores = &**m_semaphore;
+    info.pWaitSemaphores = &*m_semaphores[currentFrame];
 
     m_presentQueue->presentKHR(info);
 }
\ No newline at end of file
@@ -312,6 +312,30 @@ void RenderGraph::Node::addExternalSignal(vk::raii::Semaphore& semaphore) {
     m_submitInfo.signalSemaphoreValues.push_back(0);
 }
 
+void RenderGraph::Node::addExternalWait(std::vector<vk::raii::Semaphore>& semaphores, vk::PipelineStageFlagBits stages) {
+    FrameSemaphores frameSemaphores = {};
+    frameSemaphores.index = m_submitInfo.waitSemaphores.size();
+
+    for (auto& semaphore : semaphores) {
+        frameSemaphores.semaphores.push_back(*semaphore);
+    }
+
+    m_submitInfo.frameWaitSemaphores.push_back(frameSemaphores);
+    addExternalWait(semaphores[0], stages);
+}
+
+void RenderGraph::Node::addExternalSignal(std::vector<vk::raii::Semaphore>& semaphores) {
+    FrameSemaphores frameSemaphores = {};
+    frameSemaphores.index = m_submitInfo.signalSemaphores.size();
+
+    for (auto& semaphore : semaphores) {
+        frameSemaphores.semaphores.push_back(*semaphore);
+    }
+
+    m_submitInfo.frameSignalSemaphores.push_back(frameSemaphores);
+    addExternalSignal(semaphores[0]);
+}
+
 void RenderGraph::Node::addUsage(BufferUsage& usage) {
     m_bufferUsages.push_back(&usage);
 }
@@ -366,6 +390,14 @@ void RenderGraph::Node::internalRender(uint32_t currentFrame) {
 }
 
 void RenderGraph::Node::submit(uint32_t currentFrame) {
+    for (auto& frameSemaphores : m_submitInfo.frameWaitSemaphores) {
+        m_submitInfo.waitSemaphores[frameSemaphores.index] = frameSemaphores.semaphores[currentFrame];
+    }
+
+    for (auto& frameSemaphores : m_submitInfo.frameSignalSemaphores) {
+        m_submitInfo.signalSemaphores[frameSemaphores.index] = frameSemaphores.semaphores[currentFrame];
+    }
+
     vk::TimelineSemaphoreSubmitInfo timelineInfo = {};
     timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(m_submitInfo.waitSemaphoreValues.size());
     timelineInfo.pWaitSemaphoreValues = m_submitInfo.waitSemaphoreValues.data();
@@ -408,6 +440,10 @@ RenderGraph::RenderGraph(vk::raii::Device& device, uint32_t framesInFlight) {
     for (uint32_t i = 0; i < framesInFlight; i++) {
         m_imageDestroyQueue.push({});
     }
+
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        m_objectDestroyQueue.push({});
+    }
 }
 
 RenderGraph::~RenderGraph() {
@@ -420,6 +456,10 @@ RenderGraph::~RenderGraph() {
     while (m_imageDestroyQueue.size() > 0) {
         m_imageDestroyQueue.pop();
     }
+
+    while (m_objectDestroyQueue.size() > 0) {
+        m_objectDestroyQueue.pop();
+    }
 }
 
 void RenderGraph::addEdge(BufferEdge&& edge) {
@@ -432,6 +472,7 @@ void RenderGraph::addEdge(ImageEdge&& edge) {
     m_edges.emplace_back(std::make_unique<ImageEdge>(std::move(edge)));
     auto& edge_ = m_edges.back();
     edge_->source().addOutput(edge_->dest(), *edge_);
+    m_imageEdges.push_back(static_cast<ImageEdge*>(edge_.get()));
 }
 
 void RenderGraph::bake() {
@@ -446,8 +487,13 @@ void RenderGraph::bake() {
     });
 
     makeSemaphores();
+    makeAttachmentInfo();
 
     m_baked = true;
+
+    for (Node* node : m_nodeList) {
+        node->onBake();
+    }
 }
 
 void RenderGraph::makeSemaphores() {
@@ -469,6 +515,27 @@ void RenderGraph::makeSemaphores() {
     }
 }
 
+//Nodes record and submit separate command buffers, and a render pass cannot span command buffers,
+//so adjacent nodes writing the same attachment cannot be merged into subpasses of one render pass.
+//Instead each node gets load/store ops and layouts that avoid redundant clears and layout round trips.
+void RenderGraph::makeAttachmentInfo() {
+    for (ImageEdge* edge : m_imageEdges) {
+        ImageUsage& source = edge->sourceUsage();
+        ImageUsage& dest = edge->destUsage();
+
+        if (dest.isAttachment() && source.isAttachment()) {
+            //an earlier node already wrote the attachment, keep its contents
+            dest.m_attachmentInfo.loadOp = vk::AttachmentLoadOp::eLoad;
+            dest.m_attachmentInfo.initialLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        }
+
+        if (source.isAttachment() && dest.imageLayout() != vk::ImageLayout::eUndefined) {
+            //leave the attachment in the layout the next node expects
+            source.m_attachmentInfo.finalLayout = dest.imageLayout();
+        }
+    }
+}
+
 void RenderGraph::wait() {
     wait(frameCount() - m_framesInFlight); //wait until previous frame finishes
 }
@@ -486,15 +553,20 @@ void RenderGraph::wait(uint32_t targetFrame) {
     m_device->waitSemaphores(info, std::numeric_limits<uint64_t>::max());
 }
 
-void RenderGraph::execute() {
-    for (auto node : m_nodeList) {
-        node->clearSync(m_currentFrame);
+bool RenderGraph::isDirty() const {
+    for (auto& node : m_nodes) {
+        if (node->isDirty()) return true;
     }
 
+    return false;
+}
+
+void RenderGraph::execute() {
     for (auto node : m_nodeList) {
-        node->preRender(m_currentFrame);
+        node->clearSync(m_currentFrame);
     }
 
+    //the frame that last used this frame's resources must finish before preRender reuses them
     wait(frameCount() - framesInFlight());
 
     m_bufferDestroyQueue.pop();
@@ -503,6 +575,13 @@ void RenderGraph::execute() {
     m_imageDestroyQueue.pop();
     m_imageDestroyQueue.push({});
 
+    m_objectDestroyQueue.pop();
+    m_objectDestroyQueue.push({});
+
+    for (auto node : m_nodeList) {
+        node->preRender(m_currentFrame);
+    }
+
     for (auto node : m_nodeList) {
         node->internalRender(m_currentFrame);
     }
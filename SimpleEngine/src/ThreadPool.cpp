@@ -0,0 +1,100 @@
+#include "SimpleEngine/ThreadPool.h"
+#include <algorithm>
+
+using namespace SEngine;
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    m_stop = false;
+
+    if (threadCount == 0) {
+        size_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        m_threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job) {
+    if (count == 0) return;
+
+    struct Batch {
+        std::atomic<size_t> next = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t running = 0;
+        std::exception_ptr error;
+    };
+
+    Batch batch;
+
+    //every runner pulls indices until none are left, so uneven jobs still balance across threads
+    auto run = [&batch, &job, count] {
+        try {
+            for (size_t i = batch.next++; i < count; i = batch.next++) {
+                job(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (!batch.error) batch.error = std::current_exception();
+            batch.next = count;
+        }
+    };
+
+    size_t helpers = std::min(m_threads.size(), count - 1);
+    batch.running = helpers;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (size_t i = 0; i < helpers; i++) {
+            m_tasks.push_back([&batch, &run] {
+                run();
+
+                std::lock_guard<std::mutex> lock(batch.mutex);
+                batch.running--;
+                batch.condition.notify_one();
+            });
+        }
+    }
+
+    m_condition.notify_all();
+
+    run();
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.condition.wait(lock, [&batch] { return batch.running == 0; });
+
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || m_tasks.size() > 0; });
+            if (m_stop && m_tasks.empty()) return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -91,7 +91,7 @@ void TransferNode::createStaging() {
     allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
     for (size_t i = 0; i < m_renderGraph->framesInFlight(); i++) {
-        m_stagingBuffers.emplace_back(std::make_unique<Buffer>(*m_engine, info, allocInfo));
+        m_stagingBuffers.emplace_back(std::make_unique<Buffer>(*m_engine, info, allocInfo, MemoryCategory::Staging, "Staging buffer"));
         m_stagingBufferPtrs.push_back(m_stagingBuffers.back()->getMapping());
     }
 }
@@ -120,6 +120,14 @@ void TransferNode::transfer(Buffer& buffer, vk::DeviceSize size, vk::DeviceSize
     }
 }
 
+bool TransferNode::hasPendingTransfer(const Buffer& buffer) const {
+    for (auto& copy : m_bufferCopies) {
+        if (copy.buffer == &buffer.buffer()) return true;
+    }
+
+    return false;
+}
+
 void TransferNode::transfer(Image& image, vk::Offset3D offset, vk::Extent3D extent, vk::ImageSubresourceLayers subresourceLayers, const void* data) {
     size_t size = (size_t)extent.width * (size_t)extent.height * (size_t)extent.depth * getFormatSize(image.format());
     if (size == 0) throw std::runtime_error("Extent must be non zero");
@@ -39,11 +39,13 @@ void Window::handleWindowResize(GLFWwindow* windowptr, int width, int height) {
     window.getSize(width, height);
 }
 
-void Window::update() {
+void Window::update(double waitTimeout) {
     m_input->preUpdate();
 
     if (minimized()) {
         glfwWaitEvents();
+    } else if (waitTimeout > 0) {
+        glfwWaitEventsTimeout(waitTimeout);
     } else {
         glfwPollEvents();
     }
@@ -27,7 +27,7 @@ RenderNode::RenderNode(SEngine::Engine& engine, SEngine::RenderGraph& graph, SEn
     );
 
     createRenderPass();
-    createFramebuffers();
+    m_framebuffers.resize(m_graphics->swapchainImages().size());
     createPipeline();
     createVertexData();
 
@@ -40,7 +40,7 @@ void RenderNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandB
 
     vk::RenderPassBeginInfo renderPassInfo = {};
     renderPassInfo.renderPass = **m_renderPass;
-    renderPassInfo.framebuffer = *m_framebuffers[imageIndex];
+    renderPassInfo.framebuffer = *getFramebuffer(imageIndex);
     renderPassInfo.renderArea = vk::Rect2D{ {}, m_graphics->swapchainExtent() };
     renderPassInfo.clearValueCount = 1;
     renderPassInfo.pClearValues = &clear;
@@ -69,25 +69,50 @@ void RenderNode::render(uint32_t currentFrame, vk::raii::CommandBuffer& commandB
     commandBuffer.endRenderPass();
 }
 
+void RenderNode::onBake() {
+    //the render pass only differs in load/store ops and layouts, so it stays compatible with the existing pipelines
+    for (auto& framebuffer : m_framebuffers) {
+        graph().queueDestroy(std::move(framebuffer));
+    }
+
+    graph().queueDestroy(std::move(m_renderPass));
+    createRenderPass();
+}
+
 void RenderNode::recreateResources(vk::raii::SwapchainKHR* swapchain) {
-    m_renderPass.reset();
+    //frames in flight may still reference these, so they are destroyed by the render graph once those frames finish
+    for (auto& framebuffer : m_framebuffers) {
+        graph().queueDestroy(std::move(framebuffer));
+    }
+
+    m_framebuffers.clear();
 
     if (swapchain == nullptr) return;
 
-    createRenderPass();
-    createFramebuffers();
+    if (m_graphics->swapchainFormat() != m_renderPassFormat) {
+        graph().queueDestroy(std::move(m_renderPass));
+        graph().queueDestroy(std::move(m_pipeline));
+        graph().queueDestroy(std::move(m_pipelineLayout));
+        createRenderPass();
+        createPipeline();
+    }
+
+    //framebuffers are created on first use of each swapchain image
+    m_framebuffers.resize(m_graphics->swapchainImages().size());
 }
 
 void RenderNode::createRenderPass() {
+    auto& attachmentInfo = m_imageUsage->attachmentInfo();
+
     vk::AttachmentDescription colorAttachment = {};
     colorAttachment.format = m_graphics->swapchainFormat();
     colorAttachment.samples = vk::SampleCountFlagBits::e1;
-    colorAttachment.loadOp = vk::AttachmentLoadOp::eClear;
-    colorAttachment.storeOp = vk::AttachmentStoreOp::eStore;
+    colorAttachment.loadOp = attachmentInfo.loadOp;
+    colorAttachment.storeOp = attachmentInfo.storeOp;
     colorAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
     colorAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-    colorAttachment.initialLayout = vk::ImageLayout::eUndefined;
-    colorAttachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+    colorAttachment.initialLayout = attachmentInfo.initialLayout;
+    colorAttachment.finalLayout = attachmentInfo.finalLayout;
 
     vk::AttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -105,14 +130,14 @@ void RenderNode::createRenderPass() {
     info.pSubpasses = &subpass;
 
     m_renderPass = std::make_unique<vk::raii::RenderPass>(m_graphics->device(), info);
+    m_renderPassFormat = colorAttachment.format;
 }
 
-void RenderNode::createFramebuffers() {
-    auto& imageViews = m_graphics->swapchainImageViews();
-    m_framebuffers.clear();
+vk::raii::Framebuffer& RenderNode::getFramebuffer(uint32_t imageIndex) {
+    auto& framebuffer = m_framebuffers[imageIndex];
 
-    for (uint32_t i = 0; i < imageViews.size(); i++) {
-        vk::Format format = m_graphics->swapchainFormat();
+    if (framebuffer == nullptr) {
+        auto& imageViews = m_graphics->swapchainImageViews();
         vk::Extent2D extent = m_graphics->swapchainExtent();
 
         vk::FramebufferCreateInfo info = {};
@@ -121,10 +146,12 @@ void RenderNode::createFramebuffers() {
         info.height = extent.height;
         info.layers = 1;
         info.attachmentCount = 1;
-        info.pAttachments = &*imageViews[i];
+        info.pAttachments = &*imageViews[imageIndex];
 
-        m_framebuffers.emplace_back(m_graphics->device(), info);
+        framebuffer = std::make_unique<vk::raii::Framebuffer>(m_graphics->device(), info);
     }
+
+    return *framebuffer;
 }
 
 vk::raii::ShaderModule RenderNode::createShader(const std::string& filename) {
@@ -227,7 +254,7 @@ void RenderNode::createPipeline() {
     info.layout = **m_pipelineLayout;
     info.renderPass = **m_renderPass;
 
-    m_pipeline = std::make_unique<vk::raii::Pipeline>(m_graphics->device(), nullptr, info);
+    m_pipeline = std::make_unique<vk::raii::Pipeline>(m_graphics->device(), m_graphics->pipelineCache(), info);
 }
 
 void RenderNode::createVertexData() {
@@ -238,7 +265,7 @@ void RenderNode::createVertexData() {
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-    m_vertexBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo);
+    m_vertexBuffer = std::make_unique<SEngine::Buffer>(*m_engine, info, allocInfo, SEngine::MemoryCategory::Vertex, "Triangle vertices");
 
     m_transferNode->transfer(*m_vertexBuffer, vertexData.size() * sizeof(Vertex), 0, vertexData.data());
 }
\ No newline at end of file
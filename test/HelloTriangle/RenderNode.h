@@ -16,6 +16,7 @@ public:
     void preRender(uint32_t currentFrame) {}
     void render(uint32_t currentFrame, vk::raii::CommandBuffer& commandBuffer);
     void postRender(uint32_t currentFrame) {}
+    void onBake();
 
 private:
     SEngine::Engine* m_engine;
@@ -23,7 +24,8 @@ private:
     SEngine::AcquireNode* m_acquireNode;
     SEngine::TransferNode* m_transferNode;
     std::unique_ptr<vk::raii::RenderPass> m_renderPass;
-    std::vector<vk::raii::Framebuffer> m_framebuffers;
+    vk::Format m_renderPassFormat;
+    std::vector<std::unique_ptr<vk::raii::Framebuffer>> m_framebuffers;
     std::unique_ptr<vk::raii::PipelineLayout> m_pipelineLayout;
     std::unique_ptr<vk::raii::Pipeline> m_pipeline;
     std::unique_ptr<SEngine::Buffer> m_vertexBuffer;
@@ -34,7 +36,7 @@ private:
     entt::scoped_connection m_swapchainConnection;
 
     void createRenderPass();
-    void createFramebuffers();
+    vk::raii::Framebuffer& getFramebuffer(uint32_t imageIndex);
 
     void recreateResources(vk::raii::SwapchainKHR* swapchain);
 